@@ -82,6 +82,7 @@
             "src/fonts/shader.c",
             "src/fonts/mat4.c",
             "src/fonts.cpp",
+            "src/fonts_cache.cpp",
 
             # image loaders
             "src/images.cpp",
@@ -0,0 +1,55 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //rects
+    const count = 500;
+    const rects = [];
+
+    for (let i = 0; i < count; i++) {
+        const r = this.createRect().w(10).h(10).fill('#FFFFFF');
+
+        g.add(r);
+        rects.push(r);
+    }
+
+    //packed updates: objectId, propId, value
+    const data = new Float64Array(count * 2 * 3);
+    let step = 0;
+
+    setInterval(() => {
+        for (let i = 0; i < count; i++) {
+            const r = rects[i];
+            const angle = (step + i) / 50;
+            const pos = i * 6;
+
+            data[pos] = r.objectId;
+            data[pos + 1] = r.x.propId;
+            data[pos + 2] = 400 + Math.cos(angle) * i * 0.7;
+
+            data[pos + 3] = r.objectId;
+            data[pos + 4] = r.y.propId;
+            data[pos + 5] = 300 + Math.sin(angle) * i * 0.5;
+        }
+
+        //single call
+        gfx.applyUpdates(data);
+        step++;
+    }, 16);
+});
@@ -0,0 +1,42 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //rect
+    const r = this.createRect().x(0).y(0).w(100).h(100).fill('#FFFFFF');
+
+    g.add(r);
+
+    //many updates per frame (only the last one is applied)
+    let pos = 0;
+
+    setInterval(() => {
+        for (let i = 0; i < 50; i++) {
+            pos = (pos + 1) % 500;
+            r.x(pos);
+        }
+    }, 5);
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('submitted: ' + stats.updatesSubmitted + ' applied: ' + stats.updatesApplied);
+    }, 1000);
+});
@@ -0,0 +1,44 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    damage: true,         //only redraw the changed region (if supported)
+    damageThreshold: 0.5  //full redraw if more than 50% of the screen changed
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //background
+    const r = this.createRect().x(0).y(0).w(this.w()).h(this.h()).fill('#336699');
+
+    g.add(r);
+
+    //clock
+    const text = this.createText().text('').fontSize(60).x(20).y(20).vAlign('top').fill('#FFFFFF');
+
+    g.add(text);
+
+    setInterval(() => {
+        text.text(new Date().toLocaleTimeString());
+    }, 1000);
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('partial frames: ' + stats.partialFrames);
+    }, 1000);
+});
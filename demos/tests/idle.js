@@ -0,0 +1,45 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx({
+    idle: true //only render if something has changed
+});
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //rect
+    const r = this.createRect().x(0).y(0).w(100).h(100);
+
+    r.fill('#FFFFFF');
+    g.add(r);
+
+    //move every 2 seconds
+    setInterval(() => {
+        r.x((r.x() + 50) % 500);
+    }, 2000);
+
+    //animation every 5 seconds
+    setInterval(() => {
+        r.opacity.anim().from(1).to(0).dur(1000).autoreverse(true).loop(2).start();
+    }, 5000);
+
+    //skipped frames
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('skipped frames: ' + stats.skippedFrames + ' idle time: ' + Math.round(stats.idleTime) + ' ms fps: ' + (stats.fps ? stats.fps.fps:0));
+    }, 1000);
+});
@@ -0,0 +1,48 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //many animations
+    let changes = 0;
+
+    for (let i = 0; i < 300; i++) {
+        const r = this.createRect().x(0).y(i * 2).w(20).h(2).fill('#FFFFFF');
+
+        g.add(r);
+
+        //JS value: only updated at the end (every third one with 10 Hz)
+        if (i % 3) {
+            r.x.notify('end');
+        } else {
+            r.x.notify(10);
+        }
+
+        r.x.watch(() => {
+            changes++;
+        });
+
+        r.x.anim().from(0).to(700).dur(2000 + i * 10).autoreverse(true).loop(-1).start();
+    }
+
+    //stats
+    setInterval(() => {
+        console.log('JS changes per second: ' + changes);
+        changes = 0;
+    }, 1000);
+});
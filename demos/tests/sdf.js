@@ -0,0 +1,41 @@
+'use strict';
+
+const amino = require('../../main.js');
+
+//create instance
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //distance field texts (all sizes share the glyphs)
+    for (let i = 0; i < 6; i++) {
+        const size = 12 + i * 12;
+        const text = this.createText().text('Distance field ' + size).fontSize(size).fontSdf(true).x(20).y(40 + i * 60).fill('#FFFFFF');
+
+        g.add(text);
+    }
+
+    //outline
+    const outlined = this.createText().text('Outline').fontSize(80).fontSdf(true).x(20).y(520).fill('#FFCC00');
+
+    outlined.outlineWidth(3).outlineFill('#CC3300');
+    g.add(outlined);
+
+    //zoom animation (no rasterization)
+    const zoom = this.createText().text('Zoom').fontSize(40).fontSdf(true).x(500).y(300).fill('#66CCFF');
+
+    g.add(zoom);
+    zoom.sx.anim().from(1).to(6).dur(3000).autoreverse(true).loop(-1).start();
+    zoom.sy.anim().from(1).to(6).dur(3000).autoreverse(true).loop(-1).start();
+});
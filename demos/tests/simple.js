@@ -195,6 +195,16 @@ function testFont() {
             console.log(' -> in ' + (endTime - startTime) + ' ms');
         });
 
+        //batch
+        font.calcTextWidths(['The quick', 'brown fox', 'jumps over the lazy dog.'], { advances: true }, function (err, res) {
+            if (err) {
+                console.log('could not get text widths: ' + err.message);
+                return;
+            }
+
+            console.log('widths: ' + res.widths.join(', ') + ' (' + res.advances.length + ' advances)');
+        });
+
     });
 }
 
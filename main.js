@@ -388,6 +388,49 @@ AminoGfx.prototype.getStats = function () {
     return stats;
 };
 
+/**
+ * Internal: batched property changes from the rendering thread.
+ *
+ * @param objs objects.
+ * @param data propId and value pairs (Float64Array).
+ */
+AminoGfx.prototype._updateProperties = function (objs, data) {
+    const count = objs.length;
+
+    for (let i = 0; i < count; i++) {
+        const obj = objs[i];
+        const prop = getPropertyWithId(obj, data[i * 2]);
+
+        if (prop) {
+            prop(data[i * 2 + 1], true);
+        }
+    }
+};
+
+/**
+ * Find property by native id.
+ */
+function getPropertyWithId(obj, id) {
+    let props = obj._propsById;
+
+    if (!props) {
+        //build lookup table
+        props = {};
+
+        for (let key of Object.keys(obj)) {
+            const prop = obj[key];
+
+            if (prop && prop.name === 'AminoProperty' && prop.propId) {
+                props[prop.propId] = prop;
+            }
+        }
+
+        obj._propsById = props;
+    }
+
+    return props[id];
+}
+
 /**
  * Find node with id.
  */
@@ -2030,6 +2073,38 @@ AminoFonts.prototype.registerFont = function (font) {
     return this;
 };
 
+/**
+ * Set the glyph cache directory.
+ *
+ * The rendered glyphs are stored per font and loaded on the next start (skips rendering).
+ */
+AminoFonts.prototype.setCacheDir = function (dir) {
+    if (dir) {
+        fs.mkdirSync(dir, { recursive: true });
+    }
+
+    this.cacheDir = dir;
+
+    return this;
+};
+
+/**
+ * Write the glyph cache of all loaded fonts.
+ *
+ * Note: pre-warmed glyphs (charset) are written automatically.
+ */
+AminoFonts.prototype.saveCache = function () {
+    for (const key in this.cache) {
+        const font = this.cache[key];
+
+        if (!(font instanceof Promise)) {
+            font._saveCache();
+        }
+    }
+
+    return this;
+};
+
 /**
  * Get a font.
  */
@@ -2042,6 +2117,7 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     const size = Math.round(descr.size || 20);
     let weight = descr.weight || 400;
     let style = descr.style || 'normal';
+    const sdf = !!descr.sdf;
 
     //console.log('getFont() ' + name + ' ' + size + ' ' + weight + ' ' + style);
 
@@ -2100,18 +2176,18 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     }
 
     //check cache
-    const key = name + '/' + weight + '/' + style;
+    const key = name + '/' + weight + '/' + style + (sdf ? '/sdf':'');
     const cached = this.cache[key];
 
     if (cached) {
         if (cached instanceof Promise) {
             cached.then(font => {
-                font.getSize(size, callback);
+                font.getSize(size, descr.charset, callback);
             }, err => {
                 callback(err);
             });
         } else {
-            cached.getSize(size, callback);
+            cached.getSize(size, descr.charset, callback);
         }
 
         return this;
@@ -2139,6 +2215,8 @@ AminoFonts.prototype.getFont = function (descr, callback) {
             const font = new AminoFonts.Font(this, {
                 data: data,
                 file: file,
+                cacheDir: this.cacheDir,
+                sdf: sdf,
 
                 name: name,
                 weight: weight,
@@ -2154,7 +2232,7 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     promise.then(font => {
         this.cache[key] = font;
 
-        font.getSize(size, callback);
+        font.getSize(size, descr.charset, callback);
     }, err => {
         callback(err);
     });
@@ -2176,10 +2254,51 @@ AminoFont.prototype.init = function () {
     this.fontSizes = {};
 };
 
+/**
+ * Charset presets.
+ */
+const charsets = {
+    ascii: [[0x20, 0x7E]],
+    latin1: [[0x20, 0x7E], [0xA0, 0xFF]]
+};
+
+/**
+ * Get the characters of a charset (string, preset name or array of [start, end] code point ranges).
+ */
+function getCharsetString(charset) {
+    if (typeof charset === 'string') {
+        const preset = charsets[charset.toLowerCase()];
+
+        if (!preset) {
+            return charset;
+        }
+
+        charset = preset;
+    }
+
+    let str = '';
+
+    for (const range of charset) {
+        for (let cp = range[0]; cp <= range[1]; cp++) {
+            str += String.fromCodePoint(cp);
+        }
+    }
+
+    return str;
+}
+
 /**
  * Load font size.
+ *
+ * The glyphs of a charset (optional) are rendered on a background thread before the size is returned.
+ * The atlas textures of all running instances are uploaded before the callback is called.
  */
-AminoFont.prototype.getSize = function (size, callback) {
+AminoFont.prototype.getSize = function (size, charset, callback) {
+    if (typeof charset === 'function') {
+        callback = charset;
+        charset = null;
+    }
+
     //check cache
     let fontSize = this.fontSizes[size];
 
@@ -2188,7 +2307,15 @@ AminoFont.prototype.getSize = function (size, callback) {
         this.fontSizes[size] = fontSize;
     }
 
-    callback(null, fontSize);
+    if (!charset) {
+        callback(null, fontSize);
+        return;
+    }
+
+    //pre-warm glyphs
+    fontSize._loadGlyphs(getCharsetString(charset), err => {
+        callback(err, fontSize);
+    });
 };
 
 //
@@ -2204,6 +2331,25 @@ AminoFontSize.prototype.calcTextWidth = function (text, callback) {
     callback(null, this._calcTextWidth(text));
 };
 
+/**
+ * Calculate the width of multiple texts.
+ *
+ * texts: array of strings or a single string
+ * opts (optional):
+ *  - breaks: end offsets (in characters) of the segments in a single string
+ *  - advances: also return the advance of each character
+ *
+ * Returns a Float32Array with the widths or { widths, advances } if advances are requested.
+ */
+AminoFontSize.prototype.calcTextWidths = function (texts, opts, callback) {
+    if (typeof opts === 'function') {
+        callback = opts;
+        opts = {};
+    }
+
+    callback(null, this._calcTextWidths(texts, opts.breaks || null, !!opts.advances));
+};
+
 //
 // AminoGfxTexture
 //
@@ -2437,6 +2583,7 @@ Text.prototype.init = function () {
         fontName:   'source',
         fontWeight: 400,
         fontStyle:  'normal',
+        fontSdf:    false, //distance field glyphs (scalable)
         font:       null,
 
         //color
@@ -2446,6 +2593,13 @@ Text.prototype.init = function () {
         opacity: 1.0,
         fill: '#ffffff',
 
+        //outline (distance field fonts)
+        outlineWidth: 0,
+        outlineR: 0,
+        outlineG: 0,
+        outlineB: 0,
+        outlineFill: '#000000',
+
         //alignment
         align:  'left',
         vAlign: 'baseline',
@@ -2456,6 +2610,7 @@ Text.prototype.init = function () {
     });
 
     this.fill.watch(watchFill);
+    this.outlineFill.watch(watchOutlineFill);
 
     //TODO lines
     //TODO textHeight
@@ -2469,8 +2624,20 @@ Text.prototype.initDone = function () {
     this.fontName.watch(this.updateFont);
     this.fontWeight.watch(this.updateFont);
     this.fontSize.watch(this.updateFont);
+    this.fontSdf.watch(this.updateFont);
 };
 
+/**
+ * Outline fill value has changed.
+ */
+function watchOutlineFill(value, prop, obj) {
+    const color = parseRGBString(value);
+
+    obj.outlineR(color.r);
+    obj.outlineG(color.g);
+    obj.outlineB(color.b);
+}
+
 /**
  * Set position.
  */
@@ -2508,6 +2675,7 @@ Text.prototype.updateFont = function (val, prop, obj) {
         size: obj.fontSize(),
         weight: obj.fontWeight(),
         style: obj.fontStyle(),
+        sdf: obj.fontSdf()
     }, (err, font) => {
         //handle errors
         if (err) {
@@ -2515,7 +2683,8 @@ Text.prototype.updateFont = function (val, prop, obj) {
 
             //try default font
             fonts.getFont({
-                size: obj.fontSize()
+                size: obj.fontSize(),
+                sdf: obj.fontSdf()
             }, (err, font) => {
                 if (err) {
                     if (DEBUG_ERRORS) {
@@ -2874,6 +3043,29 @@ function makeProp(obj, name, val) {
         return anim;
     };
 
+    /**
+     * Set the notification policy for changes on the rendering thread (e.g. animations).
+     *
+     * Values: 'frame' (default), 'end' (end of animation) or a maximum rate in Hz.
+     */
+    prop.notify = function (policy) {
+        if (!this.propId) {
+            throw new Error('property is not native');
+        }
+
+        if (policy === 'frame') {
+            obj._setNotify(this.propId, 0, 0);
+        } else if (policy === 'end') {
+            obj._setNotify(this.propId, 2, 0);
+        } else if (typeof policy === 'number' && policy > 0) {
+            obj._setNotify(this.propId, 1, 1000 / policy);
+        } else {
+            throw new Error('unknown notification policy: ' + policy);
+        }
+
+        return obj;
+    };
+
     /**
      * Bind to other property.
      *
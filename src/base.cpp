@@ -14,11 +14,25 @@
 #define MEASURE_FPS true
 #define SHOW_RENDERER_ERRORS true
 
+//idle mode: frame interval and system event polling (60 Hz)
+#define IDLE_FRAME_MS (1000.0 / 60)
+#define IDLE_POLL_MS (1000 / 60)
+
+//text layout workers
+#define TEXT_LAYOUT_THREADS 2
+
+//text layout cache (entries, max string length)
+#define TEXT_CACHE_SIZE 256
+#define TEXT_CACHE_MAX_LENGTH 1024
+
 //
 //  AminoGfx
 //
 
 AminoGfx::AminoGfx(std::string name): AminoJSEventObject(name) {
+    rootVersion = 1;
+    skippedFrames = 0;
+
     //recursive mutex needed
     pthread_mutexattr_t attr;
 
@@ -33,6 +47,13 @@ AminoGfx::AminoGfx(std::string name): AminoJSEventObject(name) {
     res = pthread_mutex_init(&animLock, &attr);
     assert(res == 0);
 
+    // idleLock
+    res = pthread_mutex_init(&idleLock, NULL);
+    assert(res == 0);
+
+    res = pthread_cond_init(&idleCond, NULL);
+    assert(res == 0);
+
     //debug
     /*
     assert(pthread_mutex_lock(&animLock) == 0);
@@ -59,6 +80,12 @@ AminoGfx::~AminoGfx() {
 
     assert(res == 0);
 
+    res = pthread_mutex_destroy(&idleLock);
+    assert(res == 0);
+
+    res = pthread_cond_destroy(&idleCond);
+    assert(res == 0);
+
     //Note: properties are deleted by base class destructor
 }
 
@@ -137,6 +164,9 @@ void AminoGfx::Init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target, AminoJSObject
     Nan::SetPrototypeMethod(tpl, "getMonitors", GetMonitors);
     Nan::SetPrototypeMethod(tpl, "setMonitor", SetMonitor);
 
+    //bulk updates
+    Nan::SetPrototypeMethod(tpl, "applyUpdates", ApplyUpdates);
+
     // stats
     Nan::SetPrototypeMethod(tpl, "_getStats", GetStats);
 
@@ -251,6 +281,9 @@ NAN_METHOD(AminoGfx::Start) {
 
     //debug
     //AminoRenderer::checkTexturePerformance();
+    //AminoRenderer::checkContextPerformance();
+    //AminoRenderer::checkMatrixPerformance();
+    //AminoFont::checkLayoutPerformance("resources/NotoSansUI-Regular.ttf");
 
     //runtime info
     obj->addRuntimeProperty();
@@ -286,6 +319,49 @@ void AminoGfx::initRenderer() {
                 swapInterval = Nan::To<v8::Integer>(swapIntervalValue).ToLocalChecked()->Value();
             }
         }
+
+        //idle mode
+        Nan::MaybeLocal<v8::Value> idleMaybe = Nan::Get(obj, Nan::New<v8::String>("idle").ToLocalChecked());
+
+        if (!idleMaybe.IsEmpty()) {
+            v8::Local<v8::Value> idleValue = idleMaybe.ToLocalChecked();
+
+            if (idleValue->IsBoolean()) {
+                idleMode = Nan::To<v8::Boolean>(idleValue).ToLocalChecked()->Value();
+            }
+        }
+
+        //culling
+        Nan::MaybeLocal<v8::Value> cullingMaybe = Nan::Get(obj, Nan::New<v8::String>("culling").ToLocalChecked());
+
+        if (!cullingMaybe.IsEmpty()) {
+            v8::Local<v8::Value> cullingValue = cullingMaybe.ToLocalChecked();
+
+            if (cullingValue->IsBoolean()) {
+                culling = Nan::To<v8::Boolean>(cullingValue).ToLocalChecked()->Value();
+            }
+        }
+
+        //damage tracking
+        Nan::MaybeLocal<v8::Value> damageMaybe = Nan::Get(obj, Nan::New<v8::String>("damage").ToLocalChecked());
+
+        if (!damageMaybe.IsEmpty()) {
+            v8::Local<v8::Value> damageValue = damageMaybe.ToLocalChecked();
+
+            if (damageValue->IsBoolean()) {
+                damageTracking = Nan::To<v8::Boolean>(damageValue).ToLocalChecked()->Value();
+            }
+        }
+
+        Nan::MaybeLocal<v8::Value> damageThresholdMaybe = Nan::Get(obj, Nan::New<v8::String>("damageThreshold").ToLocalChecked());
+
+        if (!damageThresholdMaybe.IsEmpty()) {
+            v8::Local<v8::Value> damageThresholdValue = damageThresholdMaybe.ToLocalChecked();
+
+            if (damageThresholdValue->IsNumber()) {
+                damageThreshold = Nan::To<v8::Number>(damageThresholdValue).ToLocalChecked()->Value();
+            }
+        }
     }
 }
 
@@ -301,6 +377,7 @@ void AminoGfx::setupRenderer() {
 
     renderer = new AminoRenderer(this);
     renderer->setup();
+    renderer->setCulling(culling);
 
     if (!createParams.IsEmpty()) {
         v8::Local<v8::Object> obj = Nan::New(createParams);
@@ -339,6 +416,9 @@ void AminoGfx::addRuntimeProperty() {
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
     Nan::Set(obj, Nan::New("maxTextureSize").ToLocalChecked(), Nan::New(maxTextureSize));
 
+    //limit font atlas pages
+    AminoFont::setMaxTextureSize(maxTextureSize);
+
     // 3) texture units
     GLint maxTextureImageUnits;
 
@@ -419,6 +499,15 @@ void AminoGfx::renderingThread(void *arg) {
             printf("rendering: cycle start (thread=%lu)\n", (unsigned long)threadId);
         }
 
+        //idle mode
+        if (gfx->idleMode) {
+            gfx->waitForChanges();
+
+            if (!gfx->isRenderingThreadRunning()) {
+                break;
+            }
+        }
+
         if (MEASURE_FPS) {
             gfx->measureRenderingStart();
         }
@@ -445,6 +534,91 @@ void AminoGfx::renderingThread(void *arg) {
     gfx->endRendering();
 }
 
+/**
+ * Block until the next frame has to be rendered (idle mode).
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::waitForChanges() {
+    int res = pthread_mutex_lock(&idleLock);
+
+    assert(res == 0);
+
+    if (!renderRequested && threadRunning && !hasActiveAnimations()) {
+        double start = getTime();
+
+        //block until requestRender() is called (Note: system events are polled on main thread)
+        while (!renderRequested && threadRunning && !hasActiveAnimations()) {
+            res = pthread_cond_wait(&idleCond, &idleLock);
+            assert(res == 0);
+        }
+
+        idleTime += getTime() - start;
+
+        //frames not rendered while blocked
+        skippedFrames = (uint32_t)(idleTime / IDLE_FRAME_MS);
+    }
+
+    renderRequested = false;
+
+    res = pthread_mutex_unlock(&idleLock);
+    assert(res == 0);
+}
+
+/**
+ * Check if at least one animation is running.
+ */
+bool AminoGfx::hasActiveAnimations() {
+    int res = pthread_mutex_lock(&animLock);
+
+    assert(res == 0);
+
+    bool active = false;
+    std::size_t count = animations.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (animations[i]->isActive()) {
+            active = true;
+            break;
+        }
+    }
+
+    res = pthread_mutex_unlock(&animLock);
+    assert(res == 0);
+
+    return active;
+}
+
+/**
+ * Render the next frame (wakes up the rendering thread in idle mode).
+ *
+ * Note: thread-safe.
+ */
+void AminoGfx::requestRender() {
+    if (!idleMode) {
+        return;
+    }
+
+    int res = pthread_mutex_lock(&idleLock);
+
+    assert(res == 0);
+
+    renderRequested = true;
+
+    res = pthread_cond_signal(&idleCond);
+    assert(res == 0);
+
+    res = pthread_mutex_unlock(&idleLock);
+    assert(res == 0);
+}
+
+/**
+ * New async update is available.
+ */
+void AminoGfx::notifyUpdate() {
+    requestRender();
+}
+
 /**
  * Rendering has started.
  */
@@ -530,6 +704,13 @@ void AminoGfx::startRenderingThread() {
     asyncHandle.data = this;
     uv_async_init(uv_default_loop(), &asyncHandle, AminoGfx::handleRenderEvents);
 
+    //idle mode: poll system events (rendering thread may be blocked)
+    if (idleMode) {
+        idleTimer.data = this;
+        uv_timer_init(uv_default_loop(), &idleTimer);
+        uv_timer_start(&idleTimer, AminoGfx::handleIdleTimer, IDLE_POLL_MS, IDLE_POLL_MS);
+    }
+
     //retain instance (while thread is running)
     retain();
 }
@@ -564,6 +745,22 @@ void AminoGfx::handleRenderEvents(uv_async_t *handle) {
     }
 }
 
+/**
+ * Poll system events while idle.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::handleIdleTimer(uv_timer_t *handle) {
+    AminoGfx *gfx = static_cast<AminoGfx *>(handle->data);
+
+    assert(gfx);
+
+    //create scope
+    Nan::HandleScope scope;
+
+    gfx->handleSystemEvents();
+}
+
 /**
  * Stop rendering thread.
  *
@@ -576,6 +773,9 @@ void AminoGfx::stopRenderingThread() {
 
     threadRunning = false;
 
+    //wake up (idle mode)
+    requestRender();
+
     int res = uv_thread_join(&thread);
 
     assert(res == 0);
@@ -585,9 +785,14 @@ void AminoGfx::stopRenderingThread() {
 
     assert(res == 0);
 
-    //destroy handle
+    //destroy handles
     uv_close((uv_handle_t *)&asyncHandle, NULL);
 
+    if (idleMode) {
+        uv_timer_stop(&idleTimer);
+        uv_close((uv_handle_t *)&idleTimer, NULL);
+    }
+
     //release instance
     release();
 }
@@ -629,6 +834,9 @@ void AminoGfx::render() {
     processAsyncQueue();
     processAnimations();
 
+    //send property changes to JS
+    flushJSPropertyUpdates(getTime());
+
     //send signal to main thread to handle queues
     int res = uv_async_send(&asyncHandle);
 
@@ -735,10 +943,47 @@ void AminoGfx::renderScene() {
         renderer->updateViewport(propW->value, propH->value, viewportW, viewportH);
     }
 
+    //root changed (record all commands)
+    uint32_t version = rootVersion;
+
+    if (version != renderedRootVersion) {
+        renderedRootVersion = version;
+        renderer->invalidateCommands();
+    }
+
+    //damaged region
+    if (damageTracking) {
+        int bufferAge = getBufferAge();
+
+        damagePartial = renderer->updateDamage(root, bufferAge, damageThreshold, damageRect);
+
+        if (damagePartial) {
+            partialFrames++;
+        }
+
+        setDamageRegion();
+    }
+
     renderer->initScene(propR->value, propG->value, propB->value, propOpacity->value);
     renderer->renderScene(root);
 }
 
+/**
+ * Get the age of the back buffer (0 if unknown).
+ *
+ * Note: overwrite if supported (damage tracking needs the buffer content).
+ */
+int AminoGfx::getBufferAge() {
+    return 0;
+}
+
+/**
+ * Damaged region is known (before rendering).
+ */
+void AminoGfx::setDamageRegion() {
+    //overwrite
+}
+
 /**
  * Stop rendering and free resources.
  */
@@ -778,6 +1023,18 @@ void AminoGfx::destroyAminoGfx() {
     //stop thread
     stopRenderingThread();
 
+    //pending text layouts
+    AminoTextLayouter *layouter = AminoTextLayouter::getInstance(false);
+
+    if (layouter) {
+        layouter->cancel(this);
+
+        //last instance (Note: already removed)
+        if (instanceCount == 0) {
+            AminoTextLayouter::shutdown();
+        }
+    }
+
     //bind context (to main thread)
     if (started) {
         started = false;
@@ -855,10 +1112,25 @@ void AminoGfx::fireEvent(v8::Local<v8::Object> &evt) {
     }
 }
 
+/**
+ * Handle async property updates.
+ */
+void AminoGfx::handleAsyncUpdate(AsyncPropertyUpdate *update) {
+    //default: set value
+    AminoJSEventObject::handleAsyncUpdate(update);
+
+    //background changed
+    AnyProperty *property = update->property;
+
+    if (renderer && (property == propR || property == propG || property == propB || property == propOpacity)) {
+        renderer->invalidateDamage();
+    }
+}
+
 /**
  * Handle sync property updates.
  */
-bool AminoGfx::handleSyncUpdate(AnyProperty *property, void *data) {
+bool AminoGfx::handleSyncUpdate(AnyProperty *property, async_value_t &data) {
     //debug
     //printf("handleSyncUpdate() %s\n", property->name.c_str());
 
@@ -931,10 +1203,13 @@ void AminoGfx::setRoot(AminoGroup *group) {
 
     //set
     root = group;
+    rootVersion++;
 
     if (group) {
         group->retain();
     }
+
+    requestRender();
 }
 
 /**
@@ -952,6 +1227,7 @@ NAN_METHOD(AminoGfx::UpdatePerspective) {
 
     //use in next rendering cycle
     gfx->viewportChanged = true;
+    gfx->requestRender();
 }
 
 /**
@@ -1025,6 +1301,52 @@ NAN_METHOD(AminoGfx::GetStats) {
     info.GetReturnValue().Set(obj);
 }
 
+/**
+ * Apply packed property updates.
+ *
+ * Data: Float64Array or SharedArrayBuffer with (objectId, propId, value) triples.
+ *
+ * Returns the number of updated properties. Invalid triples are skipped (see updatesRejected in getStats()).
+ */
+NAN_METHOD(AminoGfx::ApplyUpdates) {
+    AminoGfx *gfx = Nan::ObjectWrap::Unwrap<AminoGfx>(info.This());
+
+    assert(gfx);
+
+    if (info.Length() != 1) {
+        Nan::ThrowTypeError("missing data");
+        return;
+    }
+
+    std::shared_ptr<v8::BackingStore> contents;
+    double *data = NULL;
+    std::size_t count = 0;
+
+    if (info[0]->IsFloat64Array()) {
+        //Float64Array
+        v8::Local<v8::Float64Array> arr = info[0].As<v8::Float64Array>();
+
+        contents = arr->Buffer()->GetBackingStore();
+        data = (double *)((char *)contents->Data() + arr->ByteOffset());
+        count = arr->Length();
+    } else if (info[0]->IsSharedArrayBuffer()) {
+        //SharedArrayBuffer
+        v8::Local<v8::SharedArrayBuffer> buffer = info[0].As<v8::SharedArrayBuffer>();
+
+        contents = buffer->GetBackingStore();
+        data = (double *)contents->Data();
+        count = contents->ByteLength() / sizeof(double);
+    } else {
+        Nan::ThrowTypeError("Float64Array or SharedArrayBuffer expected");
+        return;
+    }
+
+    //enqueue
+    uint32_t updated = gfx->enqueuePropertyUpdates(data, count / 3);
+
+    info.GetReturnValue().Set(updated);
+}
+
 /**
  * Get runtime statistics.
  */
@@ -1039,6 +1361,33 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
     //textures
     Nan::Set(obj, Nan::New("textures").ToLocalChecked(), Nan::New(textureCount));
 
+    //fonts
+    AminoTextCache *textCache = AminoTextCache::getInstance();
+
+    Nan::Set(obj, Nan::New("fontLockContention").ToLocalChecked(), Nan::New(AminoFont::getLockContention()));
+    Nan::Set(obj, Nan::New("textCacheHits").ToLocalChecked(), Nan::New(textCache->getHits()));
+    Nan::Set(obj, Nan::New("textCacheMisses").ToLocalChecked(), Nan::New(textCache->getMisses()));
+
+    //idle mode
+    if (idleMode) {
+        int res = pthread_mutex_lock(&idleLock);
+
+        assert(res == 0);
+
+        double time = idleTime;
+
+        res = pthread_mutex_unlock(&idleLock);
+        assert(res == 0);
+
+        Nan::Set(obj, Nan::New("skippedFrames").ToLocalChecked(), Nan::New(skippedFrames.load()));
+        Nan::Set(obj, Nan::New("idleTime").ToLocalChecked(), Nan::New(time));
+    }
+
+    //damage tracking
+    if (damageTracking) {
+        Nan::Set(obj, Nan::New("partialFrames").ToLocalChecked(), Nan::New(partialFrames));
+    }
+
     //rendering performance (FPS)
     if (MEASURE_FPS && lastFPS) {
         //populate fps
@@ -1053,6 +1402,10 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
     }
 
     //renderer
+    if (renderer) {
+        renderer->getStats(obj);
+    }
+
     if (SHOW_RENDERER_ERRORS) {
         Nan::Set(obj, Nan::New("errors").ToLocalChecked(), Nan::New(rendererErrors));
     }
@@ -1292,6 +1645,28 @@ void AminoGfx::textUpdateNeeded(AminoText *text) {
  */
 void AminoGfx::updateTextNodes() {
     std::size_t count = textUpdates.size();
+    AminoTextLayouter *layouter = AminoTextLayouter::getInstance(count > 0);
+
+    if (!layouter) {
+        return;
+    }
+
+    //layout modified texts (on layout workers)
+    for (std::size_t i = 0; i < count; i++) {
+        text_layout_t *layout = textUpdates[i]->createLayout();
+
+        if (layout) {
+            layouter->submit(layout);
+        }
+    }
+
+    textUpdates.clear();
+
+    //use finished layouts
+    std::vector<text_layout_t *> layouts;
+
+    layouter->takeResults(this, layouts);
+    count = layouts.size();
 
     if (count == 0) {
         return;
@@ -1302,40 +1677,29 @@ void AminoGfx::updateTextNodes() {
     double startTime = getTime(), diff;
 #endif
 
-    //layout modified texts
-    std::vector<AminoText *> textureUpdates;
+    std::vector<texture_atlas_t *> textureUpdates;
 
     for (std::size_t i = 0; i < count; i++) {
-        AminoText *item = textUpdates[i];
+        text_layout_t *layout = layouts[i];
+        texture_atlas_t *atlas = layout->fontTexture->atlas;
 
-        if (item->layoutText()) {
-            //find texture
-            std::size_t textureCount = textureUpdates.size();
-            GLuint textureId = item->getTextureId();
-            bool found = false;
+        //Note: glyphs of outdated layouts are in the atlas too
+        bool glyphsChanged = layout->glyphsChanged;
 
-            for (std::size_t j = 0; j < textureCount; j++) {
-                AminoText *item2 = textureUpdates[j];
-
-                if (item2->getTextureId() == textureId) {
-                    found = true;
-                    break;
-                }
-            }
+        if (layout->text->applyLayout(layout)) {
+            glyphsChanged = true;
+        }
 
-            if (!found) {
-                textureUpdates.push_back(item);
-            }
+        if (glyphsChanged && std::find(textureUpdates.begin(), textureUpdates.end(), atlas) == textureUpdates.end()) {
+            textureUpdates.push_back(atlas);
         }
     }
 
-    textUpdates.clear();
-
 #if (DEBUG_FONT_PERFORMANCE == 1)
     //debug
     diff = getTime() - startTime;
     if (diff > 5) {
-        printf("layoutText: %i ms\n", (int)diff);
+        printf("applyLayout: %i ms\n", (int)diff);
     }
 #endif
 
@@ -1348,13 +1712,11 @@ void AminoGfx::updateTextNodes() {
 #endif
 
     for (std::size_t i = 0; i < textureCount; i++) {
-        AminoText *item = textureUpdates[i];
+        texture_atlas_t *atlas = textureUpdates[i];
 
-        item->updateTexture();
+        AminoText::updateTexture(this, atlas);
 
         //inform other amino instances to update shared texture
-        texture_atlas_t *atlas = item->fontSize->fontTexture->atlas;
-
         atlasTextureHasChanged(atlas);
     }
 
@@ -1376,23 +1738,67 @@ void AminoGfx::atlasTextureHasChanged(texture_atlas_t *atlas) {
     //overwrite
 }
 
+/**
+ * Layout a text again (e.g. after one of its atlas pages was evicted).
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::relayoutText(AminoText *text) {
+    if (text->layoutText()) {
+        texture_atlas_t *atlas = text->fontSize->fontTexture->atlas;
+
+        AminoText::updateTexture(this, atlas);
+
+        //inform other amino instances to update shared texture
+        atlasTextureHasChanged(atlas);
+    }
+}
+
+/**
+ * Get all pages of an atlas.
+ *
+ * Note: layout workers add pages (uses the glyph lock).
+ */
+void AminoGfx::getAtlasPages(texture_atlas_t *atlas, std::vector<texture_atlas_t *> &pages) {
+    AminoFont *font = AminoFont::fromAtlas(atlas);
+
+    if (font) {
+        font->lockGlyphs();
+    }
+
+    for (texture_atlas_t *page = atlas; page; page = page->next) {
+        pages.push_back(page);
+    }
+
+    if (font) {
+        font->unlockGlyphs();
+    }
+}
+
 /**
  * Shared atlas texture has to be updated.
  *
  * Note: called on main thread
  */
 void AminoGfx::updateAtlasTexture(texture_atlas_t *atlas) {
-    //check if texture exists
-    bool newTexture;
-    amino_atlas_t texture = getAtlasTexture(atlas, false, newTexture);
+    //snapshot pages
+    std::vector<texture_atlas_t *> pages;
 
-    if (texture.textureId != INVALID_TEXTURE) {
-        if (DEBUG_BASE) {
-            printf("enqueue: atlas texture update\n");
-        }
+    getAtlasPages(atlas, pages);
+
+    for (auto const &page : pages) {
+        //check if texture exists
+        bool newTexture;
+        amino_atlas_t *texture = getAtlasTexture(page, false, newTexture);
+
+        if (texture) {
+            if (DEBUG_BASE) {
+                printf("enqueue: atlas texture update (page %i)\n", page->page);
+            }
 
-        //switch to rendering thread
-        AminoJSObject::enqueueValueUpdate(texture.textureId, atlas, static_cast<asyncValueCallback>(&AminoGfx::updateAtlasTextureHandler));
+            //switch to rendering thread
+            AminoJSObject::enqueueValueUpdate(texture->textureId, page, static_cast<asyncValueCallback>(&AminoGfx::updateAtlasTextureHandler));
+        }
     }
 }
 
@@ -1408,8 +1814,12 @@ void AminoGfx::updateAtlasTextureHandler(AsyncValueUpdate *update, int state) {
     //printf("%p: texture update %i\n", this, (int)update->valueUint32);
 
     texture_atlas_t *atlas = (texture_atlas_t *)update->data;
+    bool newTexture;
+    amino_atlas_t *texture = getAtlasTexture(atlas, false, newTexture);
+
+    assert(texture);
 
-    AminoText::updateTextureFromAtlas(update->valueUint32, atlas);
+    AminoText::updateTextureFromAtlas(texture, atlas);
 }
 
 /**
@@ -1417,7 +1827,7 @@ void AminoGfx::updateAtlasTextureHandler(AsyncValueUpdate *update, int state) {
  *
  * Note: has to be called on OpenGL thread (if createIfMissing is true).
  */
-amino_atlas_t AminoGfx::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
+amino_atlas_t* AminoGfx::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
     assert(renderer);
 
     return renderer->getAtlasTexture(atlas, createIfMissing, newTexture);
@@ -1441,27 +1851,532 @@ void AminoGfx::updateAtlasTextures(texture_atlas_t *atlas) {
     }
 }
 
-//static initializers
-int AminoGfx::instanceCount = 0;
-std::vector<AminoGfx *> AminoGfx::instances;
-
-//
-// AminoGroupFactory
-//
-
 /**
- * Group factory constructor.
+ * Upload all atlas pages in all instances (missing textures are created).
+ *
+ * Note: called on main thread. done() is called on main thread once all uploads were applied.
  */
-AminoGroupFactory::AminoGroupFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoGroup", callback) {
-    //empty
+void AminoGfx::uploadAtlasTextures(texture_atlas_t *atlas, void (*done)(void *data), void *data) {
+    atlas_upload_t *upload = new atlas_upload_t();
+
+    upload->pending = 1; //released below
+    upload->done = done;
+    upload->data = data;
+
+    //snapshot pages
+    std::vector<texture_atlas_t *> pages;
+
+    getAtlasPages(atlas, pages);
+
+    for (auto const &item : instances) {
+        if (!item->isRenderingThreadRunning()) {
+            continue;
+        }
+
+        for (auto const &page : pages) {
+            atlas_page_upload_t *pageUpload = new atlas_page_upload_t();
+
+            pageUpload->upload = upload;
+            pageUpload->page = page;
+            upload->pending++;
+
+            //switch to rendering thread (Note: cleanup handler is called in any case)
+            item->AminoJSObject::enqueueValueUpdate(0, pageUpload, static_cast<asyncValueCallback>(&AminoGfx::uploadAtlasTextureHandler));
+        }
+    }
+
+    finishAtlasUpload(upload);
 }
 
 /**
- * Create group instance.
+ * Create and upload an atlas texture.
  */
-AminoJSObject* AminoGroupFactory::create() {
-    return new AminoGroup();
-}
+void AminoGfx::uploadAtlasTextureHandler(AsyncValueUpdate *update, int state) {
+    atlas_page_upload_t *pageUpload = (atlas_page_upload_t *)update->data;
+
+    if (state == AsyncValueUpdate::STATE_APPLY) {
+        //on rendering thread
+        bool newTexture;
+        amino_atlas_t *texture = getAtlasTexture(pageUpload->page, true, newTexture);
+
+        assert(texture);
+
+        AminoText::updateTextureFromAtlas(texture, pageUpload->page);
+    } else if (state == AsyncValueUpdate::STATE_DELETE) {
+        //on main thread (applied or instance destroyed)
+        finishAtlasUpload(pageUpload->upload);
+
+        delete pageUpload;
+        update->data = NULL;
+    }
+}
+
+/**
+ * One upload is done.
+ *
+ * Note: done() is called by a timer (async queue may be processed right now).
+ */
+void AminoGfx::finishAtlasUpload(atlas_upload_t *upload) {
+    assert(upload->pending > 0);
+
+    upload->pending--;
+
+    if (upload->pending > 0) {
+        return;
+    }
+
+    upload->timer.data = upload;
+    uv_timer_init(uv_default_loop(), &upload->timer);
+    uv_timer_start(&upload->timer, AminoGfx::handleAtlasUploadDone, 0, 0);
+}
+
+/**
+ * Free atlas upload.
+ */
+static void free_atlas_upload(uv_handle_t *handle) {
+    delete (atlas_upload_t *)handle->data;
+}
+
+/**
+ * All uploads are done.
+ */
+void AminoGfx::handleAtlasUploadDone(uv_timer_t *handle) {
+    atlas_upload_t *upload = static_cast<atlas_upload_t *>(handle->data);
+
+    //create scope
+    Nan::HandleScope scope;
+
+    upload->done(upload->data);
+
+    uv_close((uv_handle_t *)&upload->timer, free_atlas_upload);
+}
+
+//static initializers
+int AminoGfx::instanceCount = 0;
+std::vector<AminoGfx *> AminoGfx::instances;
+
+//
+// AminoTextCache
+//
+
+AminoTextCache::AminoTextCache() {
+    int res = uv_mutex_init(&lock);
+
+    assert(res == 0);
+
+    hits = 0;
+    misses = 0;
+}
+
+/**
+ * Get the shared instance.
+ */
+AminoTextCache* AminoTextCache::getInstance() {
+    static AminoTextCache *cache = new AminoTextCache();
+
+    return cache;
+}
+
+/**
+ * Get the cache key of a layout.
+ */
+text_cache_key_t AminoTextCache::getKey(text_layout_t *layout) {
+    text_cache_key_t key = { layout->fontTexture, layout->scale, layout->str, layout->wrap, layout->width, layout->maxLines };
+
+    return key;
+}
+
+/**
+ * Fill the layout from the cache.
+ *
+ * Note: the glyphs of the font have to be locked.
+ */
+bool AminoTextCache::get(text_layout_t *layout) {
+    if (layout->str.size() > TEXT_CACHE_MAX_LENGTH) {
+        return false;
+    }
+
+    uv_mutex_lock(&lock);
+
+    std::map<text_cache_key_t, std::list<text_cache_entry_t>::iterator>::iterator it = index.find(getKey(layout));
+
+    if (it == index.end()) {
+        misses++;
+        uv_mutex_unlock(&lock);
+
+        return false;
+    }
+
+    //check evicted pages
+    std::list<text_cache_entry_t>::iterator entry = it->second;
+    texture_atlas_t *page = layout->fontTexture->atlas;
+
+    for (size_t generation : entry->generations) {
+        if (!page || page->generation != generation) {
+            index.erase(it);
+            entries.erase(entry);
+
+            misses++;
+            uv_mutex_unlock(&lock);
+
+            return false;
+        }
+
+        page = page->next;
+    }
+
+    //most recently used
+    entries.splice(entries.begin(), entries, entry);
+
+    //copy
+    vertex_buffer_t *buffer = layout->buffer;
+
+    if (!entry->items.empty()) {
+        vertex_buffer_push_back_vertices(buffer, entry->vertices.data(), entry->vertices.size());
+        vertex_buffer_push_back_indices(buffer, entry->indices.data(), entry->indices.size());
+        vector_push_back_data(buffer->items, entry->items.data(), entry->items.size());
+    }
+
+    layout->lineNr = entry->lineNr;
+    layout->lineW = entry->lineW;
+    memcpy(layout->bounds, entry->bounds, sizeof(layout->bounds));
+    layout->generations = entry->generations;
+
+    hits++;
+    uv_mutex_unlock(&lock);
+
+    return true;
+}
+
+/**
+ * Add a rendered layout.
+ */
+void AminoTextCache::put(text_layout_t *layout) {
+    if (layout->str.size() > TEXT_CACHE_MAX_LENGTH) {
+        return;
+    }
+
+    vertex_buffer_t *buffer = layout->buffer;
+    text_cache_entry_t item;
+
+    item.key = getKey(layout);
+
+    vertex_t *vertices = (vertex_t *)buffer->vertices->items;
+    GLushort *indices = (GLushort *)buffer->indices->items;
+    ivec4 *items = (ivec4 *)buffer->items->items;
+
+    item.vertices.assign(vertices, vertices + vector_size(buffer->vertices));
+    item.indices.assign(indices, indices + vector_size(buffer->indices));
+    item.items.assign(items, items + vector_size(buffer->items));
+
+    item.lineNr = layout->lineNr;
+    item.lineW = layout->lineW;
+    memcpy(item.bounds, layout->bounds, sizeof(item.bounds));
+    item.generations = layout->generations;
+
+    uv_mutex_lock(&lock);
+
+    std::map<text_cache_key_t, std::list<text_cache_entry_t>::iterator>::iterator it = index.find(item.key);
+
+    if (it != index.end()) {
+        //replace
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    entries.push_front(item);
+    index[item.key] = entries.begin();
+
+    //limit
+    while (entries.size() > TEXT_CACHE_SIZE) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Remove all layouts of a font size.
+ */
+void AminoTextCache::remove(texture_font_t *fontTexture) {
+    uv_mutex_lock(&lock);
+
+    for (std::list<text_cache_entry_t>::iterator it = entries.begin(); it != entries.end();) {
+        if (it->key.fontTexture == fontTexture) {
+            index.erase(it->key);
+            it = entries.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Number of cache hits.
+ */
+uint32_t AminoTextCache::getHits() {
+    return hits;
+}
+
+/**
+ * Number of cache misses.
+ */
+uint32_t AminoTextCache::getMisses() {
+    return misses;
+}
+
+//
+// AminoTextLayouter
+//
+
+AminoTextLayouter *AminoTextLayouter::instance = NULL;
+pthread_mutex_t AminoTextLayouter::instanceLock = PTHREAD_MUTEX_INITIALIZER;
+
+AminoTextLayouter::AminoTextLayouter() {
+    int res = uv_mutex_init(&lock);
+
+    assert(res == 0);
+
+    res = uv_cond_init(&queueCond);
+    assert(res == 0);
+
+    res = uv_cond_init(&doneCond);
+    assert(res == 0);
+
+    //workers (see shutdown())
+    for (int i = 0; i < TEXT_LAYOUT_THREADS; i++) {
+        uv_thread_t thread;
+
+        res = uv_thread_create(&thread, workerThread, this);
+        assert(res == 0);
+
+        threads.push_back(thread);
+    }
+}
+
+/**
+ * Free remaining layouts (workers have to be stopped).
+ */
+AminoTextLayouter::~AminoTextLayouter() {
+    for (auto const &layout : layouts) {
+        AminoText::deleteLayout(layout);
+    }
+
+    uv_cond_destroy(&queueCond);
+    uv_cond_destroy(&doneCond);
+    uv_mutex_destroy(&lock);
+}
+
+/**
+ * Get the shared instance.
+ *
+ * Note: thread-safe.
+ */
+AminoTextLayouter* AminoTextLayouter::getInstance(bool createIfMissing) {
+    int res = pthread_mutex_lock(&instanceLock);
+
+    assert(res == 0);
+
+    if (!instance && createIfMissing) {
+        instance = new AminoTextLayouter();
+    }
+
+    AminoTextLayouter *layouter = instance;
+
+    res = pthread_mutex_unlock(&instanceLock);
+    assert(res == 0);
+
+    return layouter;
+}
+
+/**
+ * Stop the workers and free the shared instance.
+ *
+ * Note: has to be called on main thread (no rendering thread running).
+ */
+void AminoTextLayouter::shutdown() {
+    int res = pthread_mutex_lock(&instanceLock);
+
+    assert(res == 0);
+
+    AminoTextLayouter *layouter = instance;
+
+    instance = NULL;
+
+    res = pthread_mutex_unlock(&instanceLock);
+    assert(res == 0);
+
+    if (!layouter) {
+        return;
+    }
+
+    //signal workers
+    uv_mutex_lock(&layouter->lock);
+
+    layouter->stopping = true;
+
+    uv_cond_broadcast(&layouter->queueCond);
+    uv_mutex_unlock(&layouter->lock);
+
+    //wait
+    for (auto &thread : layouter->threads) {
+        res = uv_thread_join(&thread);
+        assert(res == 0);
+    }
+
+    delete layouter;
+}
+
+/**
+ * Queue a layout.
+ */
+void AminoTextLayouter::submit(text_layout_t *layout) {
+    uv_mutex_lock(&lock);
+
+    queue.push_back(layout);
+    layouts.push_back(layout);
+
+    uv_cond_signal(&queueCond);
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Get the finished layouts of an instance.
+ */
+void AminoTextLayouter::takeResults(AminoGfx *gfx, std::vector<text_layout_t *> &results) {
+    uv_mutex_lock(&lock);
+
+    for (std::vector<text_layout_t *>::iterator it = layouts.begin(); it != layouts.end();) {
+        text_layout_t *layout = *it;
+
+        if (layout->gfx == gfx && layout->done) {
+            results.push_back(layout);
+            it = layouts.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Cancel all layouts of a text.
+ *
+ * Note: waits for running layouts.
+ */
+void AminoTextLayouter::cancel(AminoText *text) {
+    cancelLayouts(text);
+}
+
+/**
+ * Cancel all layouts of an instance.
+ *
+ * Note: waits for running layouts.
+ */
+void AminoTextLayouter::cancel(AminoGfx *gfx) {
+    cancelLayouts(gfx);
+}
+
+/**
+ * Remove the layouts of a text or instance.
+ */
+void AminoTextLayouter::cancelLayouts(void *owner) {
+    uv_mutex_lock(&lock);
+
+    bool running;
+
+    do {
+        running = false;
+
+        for (std::vector<text_layout_t *>::iterator it = layouts.begin(); it != layouts.end();) {
+            text_layout_t *layout = *it;
+
+            if (layout->text != owner && layout->gfx != owner) {
+                it++;
+                continue;
+            }
+
+            if (layout->running) {
+                running = true;
+                it++;
+                continue;
+            }
+
+            //remove
+            queue.erase(std::remove(queue.begin(), queue.end(), layout), queue.end());
+            it = layouts.erase(it);
+
+            AminoText::deleteLayout(layout);
+        }
+
+        if (running) {
+            uv_cond_wait(&doneCond, &lock);
+        }
+    } while (running);
+
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Layout worker.
+ */
+void AminoTextLayouter::workerThread(void *arg) {
+    AminoTextLayouter *layouter = static_cast<AminoTextLayouter *>(arg);
+
+    assert(layouter);
+
+    uv_mutex_lock(&layouter->lock);
+
+    while (!layouter->stopping) {
+        if (layouter->queue.empty()) {
+            uv_cond_wait(&layouter->queueCond, &layouter->lock);
+            continue;
+        }
+
+        text_layout_t *layout = layouter->queue.front();
+
+        layouter->queue.pop_front();
+        layout->running = true;
+
+        uv_mutex_unlock(&layouter->lock);
+
+        AminoText::renderLayout(layout);
+
+        uv_mutex_lock(&layouter->lock);
+
+        layout->running = false;
+        layout->done = true;
+
+        //render next frame
+        layout->gfx->requestRender();
+
+        uv_cond_broadcast(&layouter->doneCond);
+    }
+
+    uv_mutex_unlock(&layouter->lock);
+}
+
+//
+// AminoGroupFactory
+//
+
+/**
+ * Group factory constructor.
+ */
+AminoGroupFactory::AminoGroupFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoGroup", callback) {
+    //empty
+}
+
+/**
+ * Create group instance.
+ */
+AminoJSObject* AminoGroupFactory::create() {
+    return new AminoGroup();
+}
 
 //
 // AminoRectFactory
@@ -1560,28 +2475,29 @@ AminoJSObject* AminoTextFactory::create() {
 /**
  * Update texture.
  */
-void AminoText::updateTexture() {
+void AminoText::updateTexture(AminoGfx *gfx, texture_atlas_t *atlas) {
     if (DEBUG_FONT_UPDATES) {
-        std::string info = fontSize->font->getFontInfo();
-
-        printf("-> update font texture: %s\n", info.c_str());
+        printf("-> update font texture: %ix%i\n", (int)atlas->width, (int)atlas->height);
     }
 
-    assert(texture.textureId != INVALID_TEXTURE);
-    assert(fontSize);
-    assert(fontSize->fontTexture);
-
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
-
+    assert(gfx);
     assert(atlas);
 
-    updateTextureFromAtlas(texture.textureId, atlas);
+    //update all pages having a texture
+    for (texture_atlas_t *page = atlas; page; page = page->next) {
+        bool newTexture;
+        amino_atlas_t *texture = gfx->getAtlasTexture(page, false, newTexture);
+
+        if (texture) {
+            updateTextureFromAtlas(texture, page);
+        }
+    }
 }
 
 /**
  * Update texture from atlas.
  */
-void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas) {
+void AminoText::updateTextureFromAtlas(amino_atlas_t *texture, texture_atlas_t *atlas) {
     //update texture
     if (DEBUG_BASE) {
         printf("-> updateTexture()\n");
@@ -1620,15 +2536,34 @@ void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas)
         printf("\n");
     }
 
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    glBindTexture(GL_TEXTURE_2D, texture->textureId);
 
-    //Note: glTexSubImage2D() would probably be faster
+    GLenum format = atlas->depth == 1 ? GL_ALPHA:GL_RGB; //Note: RGB not supported so far
 
-    if (atlas->depth == 1) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas->width, atlas->height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas->data);
-    } else if (atlas->depth == 3) {
-        //Note: not supported so far
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, atlas->width, atlas->height, 0, GL_RGB, GL_UNSIGNED_BYTE, atlas->data);
+    //Note: glyphs are rendered on the main thread and layout workers too
+    AminoFont *font = AminoFont::fromAtlas(atlas);
+
+    if (font) {
+        font->lockGlyphs();
+    }
+
+    if (texture->version == 0) {
+        //allocate
+        glTexImage2D(GL_TEXTURE_2D, 0, format, atlas->width, atlas->height, 0, format, GL_UNSIGNED_BYTE, atlas->data);
+    } else {
+        //modified rows only (Note: GL_UNPACK_ROW_LENGTH is not available on OpenGL ES 2.0)
+        ivec4 region;
+
+        if (texture_atlas_get_dirty(atlas, texture->version, &region)) {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, region.y, atlas->width, region.height, format, GL_UNSIGNED_BYTE, atlas->data + region.y * atlas->width * atlas->depth);
+        }
+    }
+
+    texture->version = atlas->version;
+
+    if (font) {
+        font->unlockGlyphs();
     }
 
     //printf("font texture updated\n");
@@ -1636,10 +2571,29 @@ void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas)
 }
 
 /**
- * Get the font texture.
+ * Mark the atlas pages of the text as used.
+ *
+ * Returns false if a page was evicted and the text has to be layouted again.
  */
-GLuint AminoText::getTextureId() {
-    return texture.textureId;
+bool AminoText::touchAtlasPages() {
+    bool valid = true;
+
+    fontSize->font->lockGlyphs();
+
+    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
+
+    for (auto const &page : pages) {
+        if (page.generation != page.atlas->generation) {
+            valid = false;
+            break;
+        }
+
+        texture_atlas_touch(atlas, page.atlas);
+    }
+
+    fontSize->font->unlockGlyphs();
+
+    return valid;
 }
 
 /**
@@ -1676,7 +2630,7 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
             int kerning = 0;
 
             if (linePos > 0) {
-                kerning = texture_glyph_get_kerning(glyph, lastTextPos);
+                kerning = texture_font_get_kerning(font, utf8_to_utf32(lastTextPos), glyph->codepoint);
             }
 
             //wrap
@@ -1839,10 +2793,11 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
                 }
 
                 GLushort indices[6] = { 0,1,2, 0,2,3 };
-                vertex_t vertices[4] = { { x0, y0, 0,  s0, t0 },
-                                         { x0, y1, 0,  s0, t1 },
-                                         { x1, y1, 0,  s1, t1 },
-                                         { x1, y0, 0,  s1, t0 } };
+                float page = glyph->atlas->page;
+                vertex_t vertices[4] = { { x0, y0, 0,  s0, t0,  page },
+                                         { x0, y1, 0,  s0, t1,  page },
+                                         { x1, y1, 0,  s1, t1,  page },
+                                         { x1, y0, 0,  s1, t0,  page } };
 
                 //append
                 vertex_buffer_push_back(buffer, vertices, 4, indices, 6);
@@ -1881,71 +2836,215 @@ void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, con
 }
 
 /**
- * Update the rendered text.
+ * Update the rendered text (synchronous call).
  *
  * Returns true if texture has changed and must be updated.
  */
 bool AminoText::layoutText() {
     //printf("layoutText()\n");
 
-    if (!fontSize) {
+    text_layout_t *layout = createLayout();
+
+    if (!layout) {
         //printf("-> no font\n");
 
         return false;
     }
 
+    renderLayout(layout);
+
+    return applyLayout(layout);
+}
+
+/**
+ * Create a layout of the current text values.
+ *
+ * Note: called on rendering thread.
+ */
+text_layout_t* AminoText::createLayout() {
+    //outdates running layouts
+    layoutVersion++;
+
+    if (!fontSize) {
+        return NULL;
+    }
+
+    assert(fontSize->fontTexture);
+
     if (DEBUG_FONT_UPDATES) {
-        printf("->layoutText() render text (%s)\n", fontSize->font->fontName.c_str());
+        printf("->createLayout() render text (%s)\n", fontSize->font->fontName.c_str());
     }
 
-    //Note: FreeType glyph code is not thread-safe, using lock to prevent crash on macOS if multiple AminoGfx instances are active
-    uv_mutex_lock(&freeTypeMutex);
+    text_layout_t *layout = new text_layout_t();
 
-    //create texture (needed in next calls)
-    assert(fontSize->fontTexture);
+    layout->text = this;
+    layout->gfx = getAminoGfx();
+    layout->version = layoutVersion;
+    layout->running = false;
+    layout->done = false;
 
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
-    bool newTexture;
+    layout->font = fontSize->font;
+    layout->fontTexture = fontSize->fontTexture;
+    layout->scale = fontSize->scale;
+    layout->str = propText->value;
+    layout->wrap = wrap;
+    layout->width = propW->value;
+    layout->maxLines = propMaxLines->value;
+
+    layout->buffer = NULL;
+    layout->lineNr = 1;
+    layout->lineW = 0;
+    layout->glyphsChanged = false;
+
+    return layout;
+}
+
+/**
+ * Render the glyphs of a layout.
+ *
+ * Note: thread-safe (called on layout worker or rendering thread).
+ */
+void AminoText::renderLayout(text_layout_t *layout) {
+    texture_font_t *fontTexture = layout->fontTexture;
+
+    assert(fontTexture);
+
+    //vertex & texture coordinates (page is only used to group the glyphs)
+    vertex_buffer_t *buffer = vertex_buffer_new("pos:3f,texCoord:2f,page:1f");
+
+    vertex_attribute_delete(buffer->attributes[2]);
+    buffer->attributes[2] = NULL;
+
+    layout->buffer = buffer;
+
+    //Note: the font sizes share the atlas (layouts of other fonts run concurrently)
+    layout->font->lockGlyphs();
+
+    texture_atlas_t *atlas = fontTexture->atlas;
 
     assert(atlas);
     assert(atlas->depth == 1);
 
-    if (texture.textureId == INVALID_TEXTURE) {
-        //create or use existing texture (for atlas)
-        texture = getAminoGfx()->getAtlasTexture(atlas, true, newTexture);
+    //keep the pages of this text
+    texture_atlas_lock_used(atlas);
 
-        assert(texture.textureId != INVALID_TEXTURE);
-    }
+    //cached layout
+    AminoTextCache *cache = AminoTextCache::getInstance();
 
-    //render text
-    if (buffer) {
-        vertex_buffer_clear(buffer);
-    } else {
-        //vertex & texture coordinates
-        buffer = vertex_buffer_new("pos:3f,texCoord:2f");
+    if (cache->get(layout)) {
+        layout->font->unlockGlyphs();
+
+        return;
     }
 
-    texture_font_t *fontTexture = fontSize->fontTexture;
     size_t lastGlyphCount = fontTexture->glyphs->size;
-
-    assert(fontTexture);
+    size_t lastEvictions = atlas->evictions;
 
     vec2 pen;
 
     pen.x = 0;
     pen.y = 0;
 
-    //Note: consider using async task to avoid performance issues
-    addTextGlyphs(buffer, fontTexture, propText->value.c_str(), &pen, wrap, propW->value, &lineNr, propMaxLines->value, &lineW);
+    //Note: distance field glyphs are rendered at a reference size and scaled
+    float scale = layout->scale;
+
+    addTextGlyphs(buffer, fontTexture, layout->str.c_str(), &pen, layout->wrap, layout->width / scale, &layout->lineNr, layout->maxLines, &layout->lineW);
+
+    //pages used by the glyphs
+    for (texture_atlas_t *page = atlas; page; page = page->next) {
+        layout->generations.push_back(page->generation);
+    }
+
+    layout->glyphsChanged = lastGlyphCount != fontTexture->glyphs->size || lastEvictions != atlas->evictions;
+
+    layout->font->unlockGlyphs();
 
     if (DEBUG_BASE) {
-        printf("-> layoutText() done\n");
+        printf("-> renderLayout() done\n");
+    }
+
+    //bounds
+    size_t vertexCount = vector_size(buffer->vertices);
+    GLfloat *bounds = layout->bounds;
+
+    if (scale != 1) {
+        for (size_t i = 0; i < vertexCount; i++) {
+            vertex_t *vertex = (vertex_t *)vector_get(buffer->vertices, i);
+
+            vertex->x *= scale;
+            vertex->y *= scale;
+        }
+
+        layout->lineW *= scale;
     }
 
-    size_t newGlyphCount = fontTexture->glyphs->size;
-    bool glyphsChanged = lastGlyphCount != newGlyphCount || (newTexture && newGlyphCount > 0);
+    bounds[0] = 0;
+    bounds[1] = 0;
+    bounds[2] = -1;
+    bounds[3] = -1;
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        //Note: pos:3f,texCoord:2f,page:1f
+        GLfloat *vertex = (GLfloat *)vector_get(buffer->vertices, i);
 
-    uv_mutex_unlock(&freeTypeMutex);
+        if (i == 0 || vertex[0] < bounds[0]) {
+            bounds[0] = vertex[0];
+        }
+
+        if (i == 0 || vertex[1] < bounds[1]) {
+            bounds[1] = vertex[1];
+        }
+
+        if (i == 0 || vertex[0] > bounds[2]) {
+            bounds[2] = vertex[0];
+        }
+
+        if (i == 0 || vertex[1] > bounds[3]) {
+            bounds[3] = vertex[1];
+        }
+    }
+
+    //cache
+    cache->put(layout);
+}
+
+/**
+ * Use a rendered layout.
+ *
+ * Note: called on rendering thread. Deletes the layout.
+ *
+ * Returns true if texture has changed and must be updated.
+ */
+bool AminoText::applyLayout(text_layout_t *layout) {
+    assert(layout->text == this);
+
+    if (layout->version != layoutVersion) {
+        //outdated
+        deleteLayout(layout);
+
+        return false;
+    }
+
+    //swap buffers
+    if (buffer) {
+        vertex_buffer_delete(buffer);
+    }
+
+    buffer = layout->buffer;
+    layout->buffer = NULL;
+
+    lineNr = layout->lineNr;
+    lineW = layout->lineW;
+    memcpy(textBounds, layout->bounds, sizeof(textBounds));
+
+    //group glyphs by page
+    bool newTexture = groupByPage(layout);
+    bool glyphsChanged = layout->glyphsChanged || newTexture;
+
+    deleteLayout(layout);
+
+    //redraw
+    damaged = true;
 
     //debug
     //printf("glyphs changed: %i\n", glyphsChanged);
@@ -1953,5 +3052,150 @@ bool AminoText::layoutText() {
     return glyphsChanged;
 }
 
-uv_mutex_t AminoText::freeTypeMutex;
-bool AminoText::freeTypeMutexInitialized = false;
\ No newline at end of file
+/**
+ * Free a layout.
+ */
+void AminoText::deleteLayout(text_layout_t *layout) {
+    if (layout->buffer) {
+        //Note: never uploaded
+        vertex_buffer_delete(layout->buffer);
+    }
+
+    delete layout;
+}
+
+/**
+ * Sort the indices by atlas page and collect the draw call of each page.
+ *
+ * Returns true if a new page texture was created.
+ */
+bool AminoText::groupByPage(text_layout_t *layout) {
+    texture_atlas_t *atlas = layout->fontTexture->atlas;
+    size_t pageCount = layout->generations.size();
+    std::vector<std::vector<GLushort>> indices(pageCount);
+    size_t itemCount = vector_size(buffer->items);
+    bool newTexture = false;
+
+    for (size_t i = 0; i < itemCount; i++) {
+        ivec4 *item = (ivec4 *)vector_get(buffer->items, i);
+        vertex_t *vertex = (vertex_t *)vector_get(buffer->vertices, item->vstart);
+        int page = (int)vertex->page;
+
+        assert(page >= 0 && page < (int)pageCount);
+
+        GLushort *first = (GLushort *)vector_get(buffer->indices, item->istart);
+
+        indices[page].insert(indices[page].end(), first, first + item->icount);
+    }
+
+    //sorted indices
+    AminoGfx *gfx = getAminoGfx();
+    size_t start = 0;
+    texture_atlas_t *page = atlas;
+
+    pages.clear();
+
+    for (size_t i = 0; i < pageCount; i++, page = page->next) {
+        std::vector<GLushort> &pageIndices = indices[i];
+        size_t count = pageIndices.size();
+
+        if (count == 0) {
+            continue;
+        }
+
+        //create or use existing texture (for atlas page)
+        bool created;
+        amino_atlas_t *texture = gfx->getAtlasTexture(page, true, created);
+
+        assert(texture);
+
+        if (created) {
+            newTexture = true;
+        }
+
+        //Note: generation at layout time (page may have been evicted since)
+        text_page_t item = { page, layout->generations[i], texture->textureId, start, count };
+
+        pages.push_back(item);
+
+        memcpy((GLushort *)buffer->indices->items + start, pageIndices.data(), count * sizeof(GLushort));
+
+        start += count;
+    }
+
+    return newTexture;
+}
+
+/**
+ * Get the alignment offset of the glyphs.
+ *
+ * Note: applied after flipping the y axis.
+ */
+void AminoText::getTextOffset(GLfloat &x, GLfloat &y) {
+    texture_font_t *tf = fontSize->fontTexture;
+    float scale = fontSize->scale;
+
+    x = 0;
+    y = 0;
+
+    //horizontal alignment
+    switch (align) {
+        case ALIGN_CENTER:
+            x = (propW->value - lineW) / 2;
+            break;
+
+        case ALIGN_RIGHT:
+            x = propW->value - lineW;
+            break;
+
+        case ALIGN_LEFT:
+        default:
+            break;
+    }
+
+    //vertical alignment
+    switch (vAlign) {
+        case VALIGN_TOP:
+            y = -tf->ascender * scale;
+            break;
+
+        case VALIGN_BOTTOM:
+            y = - propH->value - (tf->descender - (lineNr - 1) * tf->height) * scale;
+            break;
+
+        case VALIGN_MIDDLE:
+            y = - tf->ascender * scale - (propH->value - lineNr * tf->height * scale) / 2;
+            break;
+
+        case VALIGN_BASELINE:
+        default:
+            break;
+    }
+}
+
+/**
+ * Get the bounds of the rendered text.
+ */
+bool AminoText::getLocalBounds(GLfloat *bounds) {
+    if (!fontSize || !buffer) {
+        //nothing rendered
+        bounds[0] = 0;
+        bounds[1] = 0;
+        bounds[2] = -1;
+        bounds[3] = -1;
+
+        return true;
+    }
+
+    GLfloat x, y;
+
+    getTextOffset(x, y);
+
+    //flip the y axis
+    bounds[0] = textBounds[0] + x;
+    bounds[1] = -(textBounds[3] + y);
+    bounds[2] = textBounds[2] + x;
+    bounds[3] = -(textBounds[1] + y);
+
+    return true;
+}
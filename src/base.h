@@ -16,6 +16,9 @@
 #include <stdlib.h>
 #include <string>
 #include <map>
+#include <deque>
+#include <list>
+#include <tuple>
 
 #include "freetype-gl.h"
 #include "mat4.h"
@@ -32,11 +35,30 @@ const int ANIM  = 4;
 const int POLY  = 5;
 const int MODEL = 6;
 
+class AminoGfx;
 class AminoText;
 class AminoGroup;
 class AminoAnim;
 class AminoRenderer;
 
+/**
+ * Pending atlas texture uploads of all instances.
+ */
+typedef struct {
+    uint32_t pending;
+    void (*done)(void *data);
+    void *data;
+    uv_timer_t timer;
+} atlas_upload_t;
+
+/**
+ * Atlas page upload of an instance.
+ */
+typedef struct {
+    atlas_upload_t *upload;
+    texture_atlas_t *page;
+} atlas_page_upload_t;
+
 /**
  * Amino main class to call from JavaScript.
  *
@@ -52,15 +74,20 @@ public:
     bool addAnimation(AminoAnim *anim);
     void removeAnimation(AminoAnim *anim);
 
+    void requestRender();
+    void notifyUpdate() override;
+
     bool deleteTextureAsync(GLuint textureId);
     bool deleteBufferAsync(GLuint bufferId);
     bool deleteVertexBufferAsync(vertex_buffer_t *buffer);
 
     //text
     void textUpdateNeeded(AminoText *text);
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void relayoutText(AminoText *text);
+    amino_atlas_t* getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
     void notifyTextureCreated(int count);
     static void updateAtlasTextures(texture_atlas_t *atlas);
+    static void uploadAtlasTextures(texture_atlas_t *atlas, void (*done)(void *data), void *data);
 
     //video
     virtual AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) = 0;
@@ -79,6 +106,8 @@ protected:
     //renderer
     AminoRenderer *renderer = NULL;
     AminoGroup *root = NULL;
+    std::atomic<uint32_t> rootVersion; //changed by setRoot()
+    uint32_t renderedRootVersion = 0;
     int viewportW;
     int viewportH;
     bool viewportChanged;
@@ -96,8 +125,12 @@ protected:
 
     void updateTextNodes();
     virtual void atlasTextureHasChanged(texture_atlas_t *atlas);
+    static void getAtlasPages(texture_atlas_t *atlas, std::vector<texture_atlas_t *> &pages);
     void updateAtlasTexture(texture_atlas_t *atlas);
     void updateAtlasTextureHandler(AsyncValueUpdate *update, int state);
+    void uploadAtlasTextureHandler(AsyncValueUpdate *update, int state);
+    static void finishAtlasUpload(atlas_upload_t *upload);
+    static void handleAtlasUploadDone(uv_timer_t *handle);
 
     //performance (FPS)
     double fpsStart = 0;
@@ -119,6 +152,23 @@ protected:
     bool threadRunning = false;
     uv_async_t asyncHandle;
 
+    //idle mode
+    bool idleMode = false;
+    bool renderRequested = true;
+    double idleTime = 0; //Note: guarded by idleLock
+    std::atomic<uint32_t> skippedFrames;
+    uv_timer_t idleTimer;
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCond;
+
+    //damage tracking
+    bool culling = true;
+    bool damageTracking = false;
+    GLfloat damageThreshold = 0.5f; //max screen fraction
+    bool damagePartial = false;
+    GLint damageRect[4]; //x, y, w, h (window coordinates)
+    uint32_t partialFrames = 0;
+
     //properties
     FloatProperty *propX;
     FloatProperty *propY;
@@ -159,14 +209,19 @@ protected:
     bool isRenderingThreadRunning();
     static void renderingThread(void *arg);
     static void handleRenderEvents(uv_async_t *handle);
+    static void handleIdleTimer(uv_timer_t *handle);
     virtual void handleSystemEvents() = 0;
 
     virtual void initRendering();
+    void waitForChanges();
+    bool hasActiveAnimations();
     virtual void render();
     virtual void endRendering();
     void processAnimations();
     virtual bool bindContext() = 0;
     virtual void renderScene();
+    virtual int getBufferAge();
+    virtual void setDamageRegion();
     virtual void renderingDone() = 0;
     bool isRendering();
 
@@ -180,7 +235,8 @@ protected:
 
     void fireEvent(v8::Local<v8::Object> &obj);
 
-    bool handleSyncUpdate(AnyProperty *prop, void *data) override;
+    bool handleSyncUpdate(AnyProperty *prop, async_value_t &data) override;
+    void handleAsyncUpdate(AsyncPropertyUpdate *update) override;
     virtual void updateWindowSize() = 0;
     virtual void updateWindowPosition() = 0;
     virtual void updateWindowTitle() = 0;
@@ -207,6 +263,7 @@ private:
     static NAN_METHOD(GetMonitors);
     static NAN_METHOD(SetMonitor);
     static NAN_METHOD(GetStats);
+    static NAN_METHOD(ApplyUpdates);
     static NAN_METHOD(GetTime);
 
     //animation
@@ -259,6 +316,23 @@ public:
     //visibility
     BooleanProperty *propVisible;
 
+    //cached transformation (rendering thread)
+    GLfloat localMatrix[16];
+    bool localMatrixDirty = true;
+    bool localMatrixIdentity = false;
+
+    GLfloat worldMatrix[16];
+    uint32_t worldMatrixVersion = 0;
+    AminoNode *worldParent = NULL;
+    uint32_t worldParentVersion = 0;
+
+    //damage tracking (rendering thread)
+    bool damaged = true;
+    GLfloat screenBounds[4]; //last frame (window coordinates: minX, minY, maxX, maxY)
+    bool screenBoundsValid = false;
+    uint32_t screenBoundsMatrix = 0; //world matrix version
+    uint32_t screenBoundsView = 0; //renderer view version
+
     AminoNode(std::string name, int type): AminoJSObject(name), type(type) {
         //empty
     }
@@ -316,6 +390,109 @@ public:
         //printf("Destroyed node: %i\n", type);
     }
 
+    /**
+     * Handle async property updates.
+     */
+    void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
+        //default: set value
+        AminoJSObject::handleAsyncUpdate(update);
+
+        //check property
+        propertyChanged(update->property);
+    }
+
+    /**
+     * Property value changed on rendering thread (async update or animation).
+     */
+    void propertyChanged(AnyProperty *property) {
+        if (isTransformProperty(property)) {
+            localMatrixDirty = true;
+        }
+
+        damaged = true;
+    }
+
+    /**
+     * Check if the property affects the local transformation.
+     */
+    bool isTransformProperty(AnyProperty *property) {
+        return property == propX || property == propY || property == propZ ||
+               property == propScaleX || property == propScaleY ||
+               property == propRotateX || property == propRotateY || property == propRotateZ ||
+               (propW && (property == propW || property == propH || property == propOriginX || property == propOriginY));
+    }
+
+    /**
+     * Invalidate the cached transformation (e.g. parent changed).
+     */
+    void invalidateTransform() {
+        localMatrixDirty = true;
+    }
+
+    /**
+     * Update the cached world matrix (on rendering thread).
+     *
+     * Note: only calculated if the node or one of its ancestors changed.
+     */
+    void updateWorldMatrix(AminoNode *parent) {
+        bool changed = false;
+
+        //local matrix
+        if (localMatrixDirty) {
+            GLfloat originX = 0;
+            GLfloat originY = 0;
+
+            if (propW) {
+                originX = propW->value * propOriginX->value;
+                originY = propH->value * propOriginY->value;
+            }
+
+            localMatrixIdentity = !make_trs_matrix(originX, originY, propX->value, propY->value, propZ->value, propScaleX->value, propScaleY->value, propRotateX->value, propRotateY->value, propRotateZ->value, localMatrix);
+            localMatrixDirty = false;
+            changed = true;
+        }
+
+        //parent
+        uint32_t parentVersion = parent ? parent->worldMatrixVersion : 0;
+
+        if (parent != worldParent || parentVersion != worldParentVersion) {
+            worldParent = parent;
+            worldParentVersion = parentVersion;
+            changed = true;
+        }
+
+        if (!changed) {
+            return;
+        }
+
+        //world matrix
+        if (!parent) {
+            copy_matrix(worldMatrix, localMatrix);
+        } else if (localMatrixIdentity) {
+            copy_matrix(worldMatrix, parent->worldMatrix);
+        } else {
+            mul_matrix(worldMatrix, parent->worldMatrix, localMatrix);
+        }
+
+        worldMatrixVersion++;
+    }
+
+    /**
+     * Get the bounds in local coordinates (minX, minY, maxX, maxY).
+     *
+     * Returns false if the bounds are unknown.
+     */
+    virtual bool getLocalBounds(GLfloat *bounds) {
+        return false;
+    }
+
+    /**
+     * Check if the content changed without a property update (e.g. texture).
+     */
+    virtual bool contentChanged() {
+        return false;
+    }
+
     /**
      * Get AminoGfx instance.
      */
@@ -359,6 +536,142 @@ public:
     AminoJSObject* create() override;
 };
 
+//font shader
+
+typedef struct {
+    float x, y, z;    // position
+    float s, t;       // texture pos
+    float page;       // atlas page (not uploaded)
+} vertex_t;
+
+/**
+ * Glyphs of a text on the same atlas page (single draw call).
+ */
+typedef struct {
+    texture_atlas_t *atlas; //page
+    size_t generation;
+    GLuint textureId;
+    size_t start; //first index
+    size_t count; //number of indices
+} text_page_t;
+
+/**
+ * Text layout (rendered by a layout worker).
+ */
+struct text_layout_t {
+    AminoText *text;
+    AminoGfx *gfx;
+    uint32_t version;
+    bool running;
+    bool done;
+
+    //input
+    AminoFont *font;
+    texture_font_t *fontTexture;
+    float scale; //glyph scale (distance field fonts)
+    std::string str;
+    int wrap;
+    int width;
+    int maxLines;
+
+    //output
+    vertex_buffer_t *buffer;
+    int lineNr;
+    float lineW;
+    GLfloat bounds[4];
+    std::vector<size_t> generations; //page generations
+    bool glyphsChanged;
+};
+
+/**
+ * Text layout worker threads.
+ */
+class AminoTextLayouter {
+public:
+    static AminoTextLayouter* getInstance(bool createIfMissing);
+    static void shutdown();
+
+    void submit(text_layout_t *layout);
+    void takeResults(AminoGfx *gfx, std::vector<text_layout_t *> &results);
+    void cancel(AminoText *text);
+    void cancel(AminoGfx *gfx);
+
+private:
+    static AminoTextLayouter *instance;
+    static pthread_mutex_t instanceLock; //rendering threads create the instance
+
+    uv_mutex_t lock;
+    uv_cond_t queueCond;
+    uv_cond_t doneCond;
+    std::deque<text_layout_t *> queue;
+    std::vector<text_layout_t *> layouts; //queued, running or done
+    std::vector<uv_thread_t> threads;
+    bool stopping = false;
+
+    AminoTextLayouter();
+    ~AminoTextLayouter();
+
+    void cancelLayouts(void *owner);
+
+    static void workerThread(void *arg);
+};
+
+/**
+ * Text layout cache key.
+ */
+struct text_cache_key_t {
+    texture_font_t *fontTexture;
+    float scale;
+    std::string str;
+    int wrap;
+    int width;
+    int maxLines;
+
+    bool operator<(const text_cache_key_t &other) const {
+        return std::tie(fontTexture, scale, wrap, width, maxLines, str) < std::tie(other.fontTexture, other.scale, other.wrap, other.width, other.maxLines, other.str);
+    }
+};
+
+/**
+ * Cached text layout (vertex buffer content).
+ */
+struct text_cache_entry_t {
+    text_cache_key_t key;
+    std::vector<vertex_t> vertices;
+    std::vector<GLushort> indices;
+    std::vector<ivec4> items;
+    int lineNr;
+    float lineW;
+    GLfloat bounds[4];
+    std::vector<size_t> generations;
+};
+
+/**
+ * Cache of text layouts (least recently used layouts are removed).
+ */
+class AminoTextCache {
+public:
+    static AminoTextCache* getInstance();
+
+    bool get(text_layout_t *layout);
+    void put(text_layout_t *layout);
+    void remove(texture_font_t *fontTexture);
+
+    uint32_t getHits();
+    uint32_t getMisses();
+
+private:
+    uv_mutex_t lock;
+    std::list<text_cache_entry_t> entries; //most recently used first
+    std::map<text_cache_key_t, std::list<text_cache_entry_t>::iterator> index;
+    std::atomic<uint32_t> hits; //Note: read by main thread
+    std::atomic<uint32_t> misses;
+
+    AminoTextCache();
+
+    static text_cache_key_t getKey(text_layout_t *layout);
+};
+
 /**
  * Text node class.
  */
@@ -372,6 +685,12 @@ public:
     FloatProperty *propG;
     FloatProperty *propB;
 
+    //outline (distance field fonts)
+    FloatProperty *propOutlineWidth;
+    FloatProperty *propOutlineR;
+    FloatProperty *propOutlineG;
+    FloatProperty *propOutlineB;
+
     //box
     FloatProperty *propW;
     FloatProperty *propH;
@@ -383,6 +702,7 @@ public:
     ObjectProperty *propFont;
     AminoFontSize *fontSize = NULL;
     vertex_buffer_t *buffer = NULL;
+    std::vector<text_page_t> pages;
 
     //alignment
     Utf8Property *propAlign;
@@ -395,9 +715,8 @@ public:
     int lineNr = 1;
     float lineW = 0;
 
-    //mutex
-    static uv_mutex_t freeTypeMutex;
-    static bool freeTypeMutexInitialized;
+    //glyph bounds (minX, minY, maxX, maxY; empty if minX > maxX)
+    GLfloat textBounds[4] = { 0, 0, -1, -1 };
 
     //constants
     static const int ALIGN_LEFT   = 0x0;
@@ -414,8 +733,7 @@ public:
     static const int WRAP_WORD = 0x2;
 
     AminoText(): AminoNode(getFactory()->name, TEXT) {
-        //mutex
-        initFreeTypeMutex();
+        //empty
     }
 
     ~AminoText() {
@@ -424,19 +742,6 @@ public:
         }
     }
 
-    /**
-     * Initialize the mutex.
-     */
-    static void initFreeTypeMutex() {
-        if (!freeTypeMutexInitialized) {
-            freeTypeMutexInitialized = true;
-
-            int res = uv_mutex_init(&freeTypeMutex);
-
-            assert(res == 0);
-        }
-    }
-
     /**
      * Free all resources.
      */
@@ -474,11 +779,18 @@ public:
             }
         }
 
+        //pending layouts
+        AminoTextLayouter *layouter = AminoTextLayouter::getInstance(false);
+
+        if (layouter) {
+            layouter->cancel(this);
+        }
+
         //release object values
         propFont->destroy();
 
         fontSize = NULL;
-        texture.textureId = INVALID_TEXTURE;
+        pages.clear();
     }
 
     /**
@@ -494,6 +806,11 @@ public:
         propG = createFloatProperty("g");
         propB = createFloatProperty("b");
 
+        propOutlineWidth = createFloatProperty("outlineWidth");
+        propOutlineR = createFloatProperty("outlineR");
+        propOutlineG = createFloatProperty("outlineG");
+        propOutlineB = createFloatProperty("outlineB");
+
         propW = createFloatProperty("w");
         propH = createFloatProperty("h");
 
@@ -544,7 +861,7 @@ public:
         //printf("AminoText::handleAsyncUpdate()\n");
 
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check font updates
         AnyProperty *property = update->property;
@@ -624,7 +941,7 @@ public:
 
             //new font
             fontSize = fs;
-            texture.textureId = INVALID_TEXTURE; //reset texture
+            pages.clear(); //reset textures
 
             //debug
             //printf("-> use font: %s\n", fs->font->fontName.c_str());
@@ -643,18 +960,35 @@ public:
     bool layoutText();
 
     /**
-     * Create or update a font texture.
+     * Asynchronous text layout.
+     */
+    text_layout_t* createLayout();
+    static void renderLayout(text_layout_t *layout);
+    bool applyLayout(text_layout_t *layout);
+    static void deleteLayout(text_layout_t *layout);
+
+    /**
+     * Get the alignment offset of the glyphs.
      */
-    void updateTexture();
-    static void updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas);
+    void getTextOffset(GLfloat &x, GLfloat &y);
 
     /**
-     * Get font texture.
+     * Get the bounds of the rendered text.
+     */
+    bool getLocalBounds(GLfloat *bounds) override;
+
+    /**
+     * Mark the used atlas pages as recently used.
+     */
+    bool touchAtlasPages();
+
+    /**
+     * Create or update a font texture.
      */
-    GLuint getTextureId();
+    static void updateTexture(AminoGfx *gfx, texture_atlas_t *atlas);
+    static void updateTextureFromAtlas(amino_atlas_t *texture, texture_atlas_t *atlas);
 
 private:
-    amino_atlas_t texture = { INVALID_TEXTURE };
 
     /**
      * JS object construction.
@@ -663,7 +997,11 @@ private:
         AminoJSObject::createInstance(info, getFactory());
     }
 
+    //layout
+    uint32_t layoutVersion = 0;
+
     static void addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, const char *text, vec2 *pen, int wrap, int width, int *lineNr, int maxLines, float *lineW);
+    bool groupByPage(text_layout_t *layout);
 };
 
 /**
@@ -917,6 +1255,11 @@ public:
 
         //start
         started = true;
+
+        //wake up renderer
+        if (eventHandler) {
+            eventHandler->notifyUpdate();
+        }
     }
 
     /**
@@ -999,8 +1342,14 @@ public:
 
         //Note: only float properties supported
         FloatProperty *floatProp = static_cast<FloatProperty *>(prop);
+        float oldValue = floatProp->value;
 
         floatProp->setValue(value);
+
+        if (floatProp->value != oldValue) {
+            //Note: animated properties always belong to nodes
+            (static_cast<AminoNode *>(prop->obj))->propertyChanged(prop);
+        }
     }
 
     //TODO pause
@@ -1058,6 +1407,11 @@ public:
         //apply end state
         applyValue(end);
 
+        //final value (ignores notification policy)
+        if (prop && eventHandler) {
+            eventHandler->enqueueJSPropertyEnd(prop);
+        }
+
         //callback function
         if (then) {
             if (DEBUG_BASE) {
@@ -1090,6 +1444,13 @@ public:
         stop();
     }
 
+    /**
+     * Check if animation is running.
+     */
+    bool isActive() {
+        return started && !ended;
+    }
+
     /**
      * Next animation step.
      */
@@ -1269,6 +1630,9 @@ public:
     bool repeatX = false;
     bool repeatY = false;
 
+    //damage tracking
+    uint32_t textureVersion = 0;
+
     AminoRect(bool hasImage): AminoNode(hasImage ? getImageViewFactory()->name:getRectFactory()->name, RECT) {
         this->hasImage = hasImage;
     }
@@ -1408,7 +1772,7 @@ public:
      */
     void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check property updates
         AnyProperty *property = update->property;
@@ -1438,6 +1802,45 @@ public:
             return;
         }
     }
+
+    /**
+     * Get the rect bounds.
+     */
+    bool getLocalBounds(GLfloat *bounds) override {
+        bounds[0] = 0;
+        bounds[1] = 0;
+        bounds[2] = propW->value;
+        bounds[3] = propH->value;
+
+        return true;
+    }
+
+    /**
+     * Check texture changes (new image or video frame).
+     */
+    bool contentChanged() override {
+        if (!hasImage) {
+            return false;
+        }
+
+        AminoTexture *texture = static_cast<AminoTexture *>(propTexture->value);
+
+        if (!texture) {
+            return false;
+        }
+
+        if (texture->isVideoPlaying()) {
+            return true;
+        }
+
+        if (texture->version != textureVersion) {
+            textureVersion = texture->version;
+
+            return true;
+        }
+
+        return false;
+    }
 };
 
 /**
@@ -1675,7 +2078,7 @@ public:
      */
     void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check array updates
         AnyProperty *property = update->property;
@@ -1725,6 +2128,9 @@ public:
     BooleanProperty *propClipRect;
     BooleanProperty *propDepth;
 
+    //renderer (commands have to be recorded again if changed)
+    uint32_t childrenVersion = 1;
+
     AminoGroup(): AminoNode(getFactory()->name, GROUP) {
         //empty
     }
@@ -1847,6 +2253,8 @@ private:
         }
 
         children.push_back(node);
+        childrenVersion++;
+        node->invalidateTransform();
 
         //debug (provoke crash to get stack trace)
         if (DEBUG_CRASH) {
@@ -1901,6 +2309,8 @@ private:
             }
 
             children.insert(children.begin() + data->pos, data->child);
+            childrenVersion++;
+            data->child->invalidateTransform();
         } else if (state == AsyncValueUpdate::STATE_DELETE) {
             //on main thread
             group_insert_t *data = (group_insert_t *)update->data;
@@ -1949,14 +2359,8 @@ private:
         assert(pos != children.end());
 
         children.erase(pos);
+        childrenVersion++;
     }
 };
 
-//font shader
-
-typedef struct {
-    float x, y, z;    // position
-    float s, t;       // texture pos
-} vertex_t;
-
 #endif
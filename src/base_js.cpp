@@ -1,6 +1,8 @@
 #include "base_js.h"
 
 #include <sstream>
+#include <cmath>
+#include <cfloat>
 
 #define DEBUG_ASYNC false
 #define DEBUG_JS_INSTANCES false
@@ -40,6 +42,8 @@ AminoJSObject::AminoJSObject(std::string name): name(name) {
     activeInstances++;
     totalInstances++;
 
+    objectId = ++lastObjectId;
+
     if (DEBUG_JS_INSTANCES) {
         jsInstances.push_back(this);
     }
@@ -90,6 +94,13 @@ std::string AminoJSObject::getName() {
     return name;
 }
 
+/**
+ * Get unique object id.
+ */
+uint32_t AminoJSObject::getObjectId() {
+    return objectId;
+}
+
 /**
  * Initialize the native object with parameters passed to the constructor. Called before JS init().
  */
@@ -177,6 +188,9 @@ v8::Local<v8::FunctionTemplate> AminoJSObject::createTemplate(AminoJSObjectFacto
     tpl->SetClassName(Nan::New(factory->name).ToLocalChecked());
     tpl->InstanceTemplate()->SetInternalFieldCount(1); //object reference only stored
 
+    //methods
+    Nan::SetPrototypeMethod(tpl, "_setNotify", SetPropertyNotify);
+
     return tpl;
 }
 
@@ -205,6 +219,9 @@ void AminoJSObject::createInstance(Nan::NAN_METHOD_ARGS_TYPE info, AminoJSObject
     //bind to C++ instance
     obj->Wrap(info.This());
 
+    //object id (bulk updates)
+    Nan::Set(info.This(), Nan::New<v8::String>("objectId").ToLocalChecked(), Nan::New(obj->objectId));
+
     //pre-init
     obj->preInit(info);
 
@@ -457,10 +474,11 @@ void AminoJSObject::addProperty(AnyProperty *prop) {
         prop->connected = true;
 
         //set default value
-        bool valid = false;
-        void *data = prop->getAsyncData(value, valid);
+        async_value_t data;
+
+        data.ptr = NULL;
 
-        if (valid) {
+        if (prop->getAsyncData(value, data)) {
             prop->setAsyncData(NULL, data);
             prop->freeAsyncData(data);
         }
@@ -486,6 +504,39 @@ NAN_METHOD(AminoJSObject::PropertyUpdated) {
     obj->enqueuePropertyUpdate(id, value);
 }
 
+/**
+ * Set the JS notification policy of a property.
+ *
+ * Note: only used for changes on the rendering thread.
+ */
+NAN_METHOD(AminoJSObject::SetPropertyNotify) {
+    assert(info.Length() == 3);
+
+    //params: propId, mode, interval
+    AminoJSObject *obj = Nan::ObjectWrap::Unwrap<AminoJSObject>(info.This());
+    uint32_t id = Nan::To<v8::Uint32>(info[0]).ToLocalChecked()->Value();
+    int32_t mode = Nan::To<v8::Int32>(info[1]).ToLocalChecked()->Value();
+    double interval = Nan::To<v8::Number>(info[2]).ToLocalChecked()->Value();
+
+    assert(obj);
+
+    AnyProperty *prop = obj->getPropertyWithId(id);
+
+    if (!prop) {
+        Nan::ThrowError("unknown property");
+        return;
+    }
+
+    if (mode != NOTIFY_FRAME && mode != NOTIFY_THROTTLE && mode != NOTIFY_END) {
+        Nan::ThrowError("unknown notification mode");
+        return;
+    }
+
+    //Note: read on rendering thread
+    prop->notifyInterval = interval;
+    prop->notifyMode = mode;
+}
+
 /**
  * Set the event handler instance.
  *
@@ -494,6 +545,7 @@ NAN_METHOD(AminoJSObject::PropertyUpdated) {
 void AminoJSObject::setEventHandler(AminoJSEventObject *handler) {
     if (eventHandler != handler) {
         if (eventHandler) {
+            eventHandler->unregisterObject(this);
             eventHandler->release();
         }
 
@@ -504,6 +556,7 @@ void AminoJSObject::setEventHandler(AminoJSEventObject *handler) {
             assert(!destroyed);
 
             handler->retain();
+            handler->registerObject(this);
         }
     }
 }
@@ -512,6 +565,11 @@ void AminoJSObject::setEventHandler(AminoJSEventObject *handler) {
  * Remove event handler.
  */
 void AminoJSObject::clearEventHandler() {
+    //pending JS notifications
+    if (eventHandler) {
+        eventHandler->removeJSPropertyUpdates(this);
+    }
+
     setEventHandler(NULL);
 }
 
@@ -571,7 +629,7 @@ bool AminoJSObject::enqueueValueUpdate(AsyncValueUpdate *update) {
 /**
  * Handly property update on main thread (optional).
  */
-bool AminoJSObject::handleSyncUpdate(AnyProperty *property, void *data) {
+bool AminoJSObject::handleSyncUpdate(AnyProperty *property, async_value_t &data) {
     //no default handling
     return false;
 }
@@ -828,6 +886,7 @@ std::string* AminoJSObject::toNewString(v8::Local<v8::Value> &value) {
 //static initializers
 uint32_t AminoJSObject::activeInstances = 0;
 uint32_t AminoJSObject::totalInstances = 0;
+uint32_t AminoJSObject::lastObjectId = 0;
 std::vector<AminoJSObject *> AminoJSObject::jsInstances;
 
 //
@@ -838,15 +897,25 @@ std::vector<AminoJSObject *> AminoJSObject::jsInstances;
  * AnyProperty constructor.
  */
 AminoJSObject::AnyProperty::AnyProperty(int type, AminoJSObject *obj, std::string name, uint32_t id): type(type), obj(obj), name(name), id(id) {
-    //empty
-
     assert(obj);
+
+    notifyMode = NOTIFY_FRAME;
+    notifyInterval = 0;
 }
 
 AminoJSObject::AnyProperty::~AnyProperty() {
     //empty
 }
 
+/**
+ * Free async data.
+ *
+ * Note: inline values have nothing to free.
+ */
+void AminoJSObject::AnyProperty::freeAsyncData(async_value_t &data) {
+    //empty
+}
+
 /**
  * Retain base object instance.
  *
@@ -914,44 +983,29 @@ v8::Local<v8::Value> AminoJSObject::FloatProperty::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: stored inline.
  */
-void* AminoJSObject::FloatProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::FloatProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNumber()) {
         //double to float
-        float f = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
-        float *res = new float;
-
-        *res = f;
-        valid = true;
+        data.f = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
 
-        return res;
+        return true;
     } else {
         if (DEBUG_BASE) {
             printf("-> default value not a number!\n");
         }
 
-        valid = false;
-
-        return NULL;
+        return false;
     }
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::FloatProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((float *)data);
-    }
-}
-
-/**
- * Free async data.
- */
-void AminoJSObject::FloatProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (float *)data;
-    }
+void AminoJSObject::FloatProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    value = data.f;
 }
 
 //
@@ -975,11 +1029,16 @@ AminoJSObject::FloatArrayProperty::~FloatArrayProperty() {
 /**
  * Update the float value.
  *
- * Note: only updates the JS value if modified!
+ * Note: only updates the JS value if modified! The vector is moved (use std::move() to avoid a copy).
  */
 void AminoJSObject::FloatArrayProperty::setValue(std::vector<float> newValue) {
-    if (value != newValue) {
-        value = newValue;
+    if (store || value != newValue) {
+        value = std::move(newValue);
+
+        //Note: has to be called on main thread if shared memory was used
+        store.reset();
+        storeData = NULL;
+        storeCount = 0;
 
         if (connected) {
             obj->updateProperty(this);
@@ -987,12 +1046,42 @@ void AminoJSObject::FloatArrayProperty::setValue(std::vector<float> newValue) {
     }
 }
 
+/**
+ * Get float values.
+ */
+float* AminoJSObject::FloatArrayProperty::getData() {
+    if (store) {
+        return storeData;
+    }
+
+    return value.data();
+}
+
+/**
+ * Get number of float values.
+ */
+std::size_t AminoJSObject::FloatArrayProperty::getSize() {
+    if (store) {
+        return storeCount;
+    }
+
+    return value.size();
+}
+
+/**
+ * Check if empty.
+ */
+bool AminoJSObject::FloatArrayProperty::isEmpty() {
+    return getSize() == 0;
+}
+
 /**
  * Convert to string value.
  */
 std::string AminoJSObject::FloatArrayProperty::toString() {
     std::ostringstream ss;
-    std::size_t count = value.size();
+    float *data = getData();
+    std::size_t count = getSize();
 
     ss << "[";
 
@@ -1001,7 +1090,7 @@ std::string AminoJSObject::FloatArrayProperty::toString() {
             ss << ", ";
         }
 
-        ss << value[i];
+        ss << data[i];
     }
 
     ss << "]";
@@ -1013,86 +1102,107 @@ std::string AminoJSObject::FloatArrayProperty::toString() {
  * Get JS value.
  */
 v8::Local<v8::Value> AminoJSObject::FloatArrayProperty::toValue() {
+    if (store) {
+        //shared memory
+        std::size_t offset = (char *)storeData - (char *)store->Data();
+
+        return v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), store), offset, storeCount);
+    }
+
     std::size_t count = value.size();
 
     //typed array
-    v8::Local<v8::Float32Array> arr = v8::Float32Array::New(v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(float)), 0, count);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(float));
 
-    //normal array
-    //v8::Local<v8::Array> arr = Nan::New<v8::Array>();
-
-    for (unsigned int i = 0; i < count; i++) {
-        Nan::Set(arr, Nan::New<v8::Uint32>(i), Nan::New<v8::Number>(value[i]));
+    if (count > 0) {
+        memcpy(buffer->GetBackingStore()->Data(), value.data(), count * sizeof(float));
     }
 
-    return arr;
+    return v8::Float32Array::New(buffer, 0, count);
 }
 
 /**
  * Get async data representation.
+ *
+ * Note: side allocation. Typed arrays are shared (zero-copy), the values should not be modified afterwards.
  */
-void* AminoJSObject::FloatArrayProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::FloatArrayProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNull()) {
         //Note: only accepting empty arrays as values
-        valid = false;
-
-        return NULL;
+        return false;
     }
 
-    std::vector<float> *vector =  NULL;
+    float_array_data_t *arrayData = NULL;
 
     if (value->IsFloat32Array()) {
-        //Float32Array
+        //Float32Array (keep backing store)
         v8::Local<v8::Float32Array> arr = v8::Local<v8::Float32Array>::Cast(value);
-        std::shared_ptr<v8::BackingStore> contents = arr->Buffer()->GetBackingStore();
-        float *data = (float *)contents->Data();
-        std::size_t count = contents->ByteLength() / sizeof(float);
 
-        //debug
-        //printf("is Float32Array (size: %i)\n", (int)count);
-
-        //copy to vector
-        vector = new std::vector<float>();
+        arrayData = new float_array_data_t();
+        arrayData->store = arr->Buffer()->GetBackingStore();
+        arrayData->data = (float *)((char *)arrayData->store->Data() + arr->ByteOffset());
+        arrayData->count = arr->Length();
 
-        vector->assign(data, data + count);
-
-        valid = true;
+        //debug
+        //printf("is Float32Array (size: %i)\n", (int)arrayData->count);
     } else if (value->IsArray()) {
         v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
         std::size_t count = arr->Length();
 
-        vector = new std::vector<float>();
+        arrayData = new float_array_data_t();
+        arrayData->data = NULL;
+        arrayData->count = 0;
+        arrayData->vector.reserve(count);
 
         for (std::size_t i = 0; i < count; i++) {
-            vector->push_back((float)(Nan::To<v8::Number>(Nan::Get(arr, i).ToLocalChecked()).ToLocalChecked()->Value()));
+            arrayData->vector.push_back((float)(Nan::To<v8::Number>(Nan::Get(arr, i).ToLocalChecked()).ToLocalChecked()->Value()));
         }
-
-        valid = true;
     } else {
-        valid = false;
+        return false;
     }
 
-    return vector;
+    data.ptr = arrayData;
+
+    return true;
 }
 
 /**
  * Apply async data.
+ *
+ * Note: the previous values are swapped into the async data and freed on main thread.
  */
-void AminoJSObject::FloatArrayProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (!data) {
+void AminoJSObject::FloatArrayProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    float_array_data_t *arrayData = (float_array_data_t *)data.ptr;
+
+    if (!arrayData) {
         value.clear();
+        store.reset();
+        storeData = NULL;
+        storeCount = 0;
         return;
     }
 
-    value = *((std::vector<float> *)data);
+    if (arrayData->store) {
+        //shared memory
+        storeData = arrayData->data;
+        storeCount = arrayData->count;
+        store.swap(arrayData->store);
+        value.swap(arrayData->vector);
+    } else {
+        //moved vector
+        value.swap(arrayData->vector);
+        store.swap(arrayData->store);
+        storeData = NULL;
+        storeCount = 0;
+    }
 }
 
 /**
  * Free async data.
  */
-void AminoJSObject::FloatArrayProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (std::vector<float> *)data;
+void AminoJSObject::FloatArrayProperty::freeAsyncData(async_value_t &data) {
+    if (data.ptr) {
+        delete (float_array_data_t *)data.ptr;
     }
 }
 
@@ -1145,43 +1255,28 @@ v8::Local<v8::Value> AminoJSObject::DoubleProperty::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: stored inline.
  */
-void* AminoJSObject::DoubleProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::DoubleProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNumber()) {
-        double d = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
-        double *res = new double;
-
-        *res = d;
-        valid = true;
+        data.d = Nan::To<v8::Number>(value).ToLocalChecked()->Value();
 
-        return res;
+        return true;
     } else {
         if (DEBUG_BASE) {
             printf("-> default value not a number!\n");
         }
 
-        valid = false;
-
-        return NULL;
+        return false;
     }
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::DoubleProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((double *)data);
-    }
-}
-
-/**
- * Free async data.
- */
-void AminoJSObject::DoubleProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (double *)data;
-    }
+void AminoJSObject::DoubleProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    value = data.d;
 }
 
 //
@@ -1260,13 +1355,13 @@ v8::Local<v8::Value> AminoJSObject::UShortArrayProperty::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: side allocation.
  */
-void* AminoJSObject::UShortArrayProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::UShortArrayProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNull()) {
         //Note: only accepting empty arrays as values
-        valid = false;
-
-        return NULL;
+        return false;
     }
 
     std::vector<ushort> *vector =  NULL;
@@ -1275,7 +1370,7 @@ void* AminoJSObject::UShortArrayProperty::getAsyncData(v8::Local<v8::Value> &val
         //Uint16Array
         v8::Local<v8::Uint16Array> arr = v8::Local<v8::Uint16Array>::Cast(value);
         std::shared_ptr<v8::BackingStore> contents = arr->Buffer()->GetBackingStore();
-        ushort *data = (ushort *)contents->Data();
+        ushort *values = (ushort *)contents->Data();
         std::size_t count = contents->ByteLength() / sizeof(ushort);
 
         //debug
@@ -1284,9 +1379,7 @@ void* AminoJSObject::UShortArrayProperty::getAsyncData(v8::Local<v8::Value> &val
         //copy to vector
         vector = new std::vector<ushort>();
 
-        vector->assign(data, data + count);
-
-        valid = true;
+        vector->assign(values, values + count);
     } else if (value->IsArray()) {
         v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
         std::size_t count = arr->Length();
@@ -1296,33 +1389,33 @@ void* AminoJSObject::UShortArrayProperty::getAsyncData(v8::Local<v8::Value> &val
         for (std::size_t i = 0; i < count; i++) {
             vector->push_back((ushort)(Nan::To<v8::Uint32>(Nan::Get(arr, i).ToLocalChecked()).ToLocalChecked()->Value()));
         }
-
-        valid = true;
     } else {
-        valid = false;
+        return false;
     }
 
-    return vector;
+    data.ptr = vector;
+
+    return true;
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::UShortArrayProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (!data) {
+void AminoJSObject::UShortArrayProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    if (!data.ptr) {
         value.clear();
         return;
     }
 
-    value = *((std::vector<ushort> *)data);
+    value = *((std::vector<ushort> *)data.ptr);
 }
 
 /**
  * Free async data.
  */
-void AminoJSObject::UShortArrayProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (std::vector<ushort> *)data;
+void AminoJSObject::UShortArrayProperty::freeAsyncData(async_value_t &data) {
+    if (data.ptr) {
+        delete (std::vector<ushort> *)data.ptr;
     }
 }
 
@@ -1375,44 +1468,29 @@ v8::Local<v8::Value> AminoJSObject::Int32Property::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: stored inline.
  */
-void* AminoJSObject::Int32Property::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::Int32Property::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNumber()) {
-        //UInt32
-        int32_t i = Nan::To<v8::Int32>(value).ToLocalChecked()->Value();
-        int32_t *res = new int32_t;
+        //Int32
+        data.i32 = Nan::To<v8::Int32>(value).ToLocalChecked()->Value();
 
-        *res = i;
-        valid = true;
-
-        return res;
+        return true;
     } else {
         if (DEBUG_BASE) {
             printf("-> default value not a number!\n");
         }
 
-        valid = false;
-
-        return NULL;
+        return false;
     }
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::Int32Property::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((int32_t *)data);
-    }
-}
-
-/**
- * Free async data.
- */
-void AminoJSObject::Int32Property::freeAsyncData(void *data) {
-    if (data) {
-        delete (int32_t *)data;
-    }
+void AminoJSObject::Int32Property::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    value = data.i32;
 }
 
 //
@@ -1464,44 +1542,29 @@ v8::Local<v8::Value> AminoJSObject::UInt32Property::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: stored inline.
  */
-void* AminoJSObject::UInt32Property::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::UInt32Property::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsNumber()) {
         //UInt32
-        uint32_t ui = Nan::To<v8::Uint32>(value).ToLocalChecked()->Value();
-        uint32_t *res = new uint32_t;
-
-        *res = ui;
-        valid = true;
+        data.u32 = Nan::To<v8::Uint32>(value).ToLocalChecked()->Value();
 
-        return res;
+        return true;
     } else {
         if (DEBUG_BASE) {
             printf("-> default value not a number!\n");
         }
 
-        valid = false;
-
-        return NULL;
+        return false;
     }
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::UInt32Property::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((uint32_t *)data);
-    }
-}
-
-/**
- * Free async data.
- */
-void AminoJSObject::UInt32Property::freeAsyncData(void *data) {
-    if (data) {
-        delete (uint32_t *)data;
-    }
+void AminoJSObject::UInt32Property::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    value = data.u32;
 }
 
 //
@@ -1553,43 +1616,28 @@ v8::Local<v8::Value> AminoJSObject::BooleanProperty::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: stored inline.
  */
-void* AminoJSObject::BooleanProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::BooleanProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsBoolean()) {
-        bool b = Nan::To<v8::Boolean>(value).ToLocalChecked()->Value();
-        bool *res = new bool;
+        data.b = Nan::To<v8::Boolean>(value).ToLocalChecked()->Value();
 
-        *res = b;
-        valid = true;
-
-        return res;
+        return true;
     } else {
         if (DEBUG_BASE) {
             printf("-> default value not a boolean!\n");
         }
 
-        valid = false;
-
-        return NULL;
+        return false;
     }
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::BooleanProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((bool *)data);
-    }
-}
-
-/**
- * Free async data.
- */
-void AminoJSObject::BooleanProperty::freeAsyncData(void *data) {
-    if (data) {
-        delete (bool *)data;
-    }
+void AminoJSObject::BooleanProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    value = data.b;
 }
 
 //
@@ -1650,31 +1698,31 @@ v8::Local<v8::Value> AminoJSObject::Utf8Property::toValue() {
 
 /**
  * Get async data representation.
+ *
+ * Note: side allocation.
  */
-void* AminoJSObject::Utf8Property::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
+bool AminoJSObject::Utf8Property::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     //convert to string
-    std::string *str = AminoJSObject::toNewString(value);
-
-    valid = true;
+    data.ptr = AminoJSObject::toNewString(value);
 
-    return str;
+    return true;
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::Utf8Property::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    if (data) {
-        value = *((std::string *)data);
+void AminoJSObject::Utf8Property::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    if (data.ptr) {
+        value = *((std::string *)data.ptr);
     }
 }
 
 /**
  * Free async data.
  */
-void AminoJSObject::Utf8Property::freeAsyncData(void *data) {
-    if (data) {
-        delete (std::string *)data;
+void AminoJSObject::Utf8Property::freeAsyncData(async_value_t &data) {
+    if (data.ptr) {
+        delete (std::string *)data.ptr;
     }
 }
 
@@ -1749,9 +1797,7 @@ v8::Local<v8::Value> AminoJSObject::ObjectProperty::toValue() {
 /**
  * Get async data representation.
  */
-void* AminoJSObject::ObjectProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
-    valid = true;
-
+bool AminoJSObject::ObjectProperty::getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) {
     if (value->IsObject()) {
         v8::Local<v8::Object> jsObj = Nan::To<v8::Object>(value).ToLocalChecked();
         AminoJSObject *obj = Nan::ObjectWrap::Unwrap<AminoJSObject>(jsObj);
@@ -1761,17 +1807,19 @@ void* AminoJSObject::ObjectProperty::getAsyncData(v8::Local<v8::Value> &value, b
         //retain reference on main thread
         obj->retain();
 
-        return obj;
+        data.ptr = obj;
     } else {
-        return NULL;
+        data.ptr = NULL;
     }
+
+    return true;
 }
 
 /**
  * Apply async data.
  */
-void AminoJSObject::ObjectProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
-    AminoJSObject *obj = static_cast<AminoJSObject *>(data);
+void AminoJSObject::ObjectProperty::setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) {
+    AminoJSObject *obj = static_cast<AminoJSObject *>(data.ptr);
 
     if (obj != value) {
         //release old instance
@@ -1801,8 +1849,8 @@ void AminoJSObject::ObjectProperty::setAsyncData(AsyncPropertyUpdate *update, vo
 /**
  * Free async data.
  */
-void AminoJSObject::ObjectProperty::freeAsyncData(void *data) {
-    AminoJSObject *obj = static_cast<AminoJSObject *>(data);
+void AminoJSObject::ObjectProperty::freeAsyncData(async_value_t &data) {
+    AminoJSObject *obj = static_cast<AminoJSObject *>(data.ptr);
 
     //release reference on main thread
     if (obj) {
@@ -1926,6 +1974,70 @@ void AminoJSObject::JSPropertyUpdate::apply() {
     property->obj->updateProperty(property->name, value);
 }
 
+//
+// AminoJSObject::JSPropertyBatchUpdate
+//
+
+AminoJSObject::JSPropertyBatchUpdate::JSPropertyBatchUpdate(AminoJSObject *obj): AnyAsyncUpdate(ASYNC_JS_UPDATE_BATCH), obj(obj) {
+    //empty
+}
+
+AminoJSObject::JSPropertyBatchUpdate::~JSPropertyBatchUpdate() {
+    //empty
+}
+
+/**
+ * Add numeric property value.
+ */
+void AminoJSObject::JSPropertyBatchUpdate::add(AnyProperty *property, double value) {
+    properties.push_back(property);
+    values.push_back(value);
+}
+
+/**
+ * Update JS properties on main thread.
+ *
+ * Note: calls _updateProperties(objs, data) with data containing propId/value pairs.
+ */
+void AminoJSObject::JSPropertyBatchUpdate::apply() {
+    std::size_t count = properties.size();
+
+    //JS handler
+    v8::Local<v8::Object> jsObj = obj->handle();
+    Nan::MaybeLocal<v8::Value> maybeFunc = Nan::Get(jsObj, Nan::New<v8::String>("_updateProperties").ToLocalChecked());
+
+    if (maybeFunc.IsEmpty() || !maybeFunc.ToLocalChecked()->IsFunction()) {
+        //single updates
+        for (std::size_t i = 0; i < count; i++) {
+            AnyProperty *property = properties[i];
+            v8::Local<v8::Value> value = Nan::New<v8::Number>(values[i]);
+
+            property->obj->updateProperty(property->name, value);
+        }
+
+        return;
+    }
+
+    //typed array
+    v8::Local<v8::Array> objs = Nan::New<v8::Array>(count);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * 2 * sizeof(double));
+    double *data = (double *)buffer->GetBackingStore()->Data();
+
+    for (std::size_t i = 0; i < count; i++) {
+        AnyProperty *property = properties[i];
+
+        Nan::Set(objs, i, property->obj->handle());
+        data[i * 2] = property->id;
+        data[i * 2 + 1] = values[i];
+    }
+
+    //call
+    int argc = 2;
+    v8::Local<v8::Value> argv[] = { objs, v8::Float64Array::New(buffer, 0, count * 2) };
+
+    Nan::Call(maybeFunc.ToLocalChecked().As<v8::Function>(), jsObj, argc, argv);
+}
+
 //
 // AminoJSObject::JSCallbackUpdate
 //
@@ -1951,9 +2063,24 @@ void AminoJSObject::JSCallbackUpdate::apply() {
 //
 
 AminoJSEventObject::AminoJSEventObject(std::string name): AminoJSObject(name) {
-    asyncUpdates = new std::vector<AnyAsyncUpdate *>();
-    asyncDeletes = new std::vector<AnyAsyncUpdate *>();
+    asyncRing = new async_record_t[ASYNC_QUEUE_SIZE];
+    asyncRingHead = 0;
+    asyncRingTail = 0;
+    asyncOverflow = false;
+
+    updatesSubmitted = 0;
+    updatesApplied = 0;
+
+    asyncUpdates = new std::vector<async_record_t>();
+    asyncDeletes = new std::vector<async_record_t>();
     jsUpdates = new std::vector<AnyAsyncUpdate *>();
+    jsPending = new std::vector<AnyProperty *>();
+
+    asyncPending = new std::vector<async_record_t>();
+    asyncApplied = new std::vector<async_record_t>();
+    asyncFreeing = new std::vector<async_record_t>();
+    jsApplying = new std::vector<AnyAsyncUpdate *>();
+    asyncBulk = new std::vector<async_record_t>();
 
     //main thread
     mainThread = uv_thread_self();
@@ -1979,15 +2106,24 @@ AminoJSEventObject::~AminoJSEventObject() {
     //JS updates
     handleJSUpdates();
     delete jsUpdates;
+    delete jsPending;
 
     //asyncUpdates
     clearAsyncQueue();
     delete asyncUpdates;
+    delete[] asyncRing;
 
     //asyncDeletes
     handleAsyncDeletes();
     delete asyncDeletes;
 
+    //swap buffers
+    delete asyncPending;
+    delete asyncApplied;
+    delete asyncFreeing;
+    delete jsApplying;
+    delete asyncBulk;
+
     //mutex
     int res = pthread_mutex_destroy(&asyncLock);
 
@@ -2009,20 +2145,35 @@ AminoJSEventObject* AminoJSEventObject::getEventHandler() {
 void AminoJSEventObject::clearAsyncQueue() {
     assert(asyncUpdates);
 
+    if (DEBUG_BASE) {
+        assert(isMainThread());
+    }
+
     int res = pthread_mutex_lock(&asyncLock);
 
     assert(res == 0);
 
+    //lock-free queue
+    uint32_t head = asyncRingHead.load(std::memory_order_acquire);
+    uint32_t tail = asyncRingTail.load(std::memory_order_relaxed);
+
+    while (tail != head) {
+        freeAsyncRecord(asyncRing[tail & (ASYNC_QUEUE_SIZE - 1)]);
+        tail++;
+    }
+
+    asyncRingTail.store(tail, std::memory_order_release);
+
+    //locked queue
     std::size_t count = asyncUpdates->size();
 
     for (std::size_t i = 0; i < count; i++) {
-        AnyAsyncUpdate *item = (*asyncUpdates)[i];
-
-        delete item;
+        freeAsyncRecord((*asyncUpdates)[i]);
     }
 
     //Note: not applied, can safely clear vector
     asyncUpdates->clear();
+    asyncOverflow = false;
 
     res = pthread_mutex_unlock(&asyncLock);
     assert(res == 0);
@@ -2040,30 +2191,28 @@ void AminoJSEventObject::handleAsyncDeletes() {
         assert(isMainThread());
     }
 
+    //take items (Note: lock is not held while freeing)
     int res = pthread_mutex_lock(&asyncLock);
 
     assert(res == 0);
 
-    std::size_t count = asyncDeletes->size();
+    asyncFreeing->swap(*asyncDeletes);
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+
+    std::size_t count = asyncFreeing->size();
 
     if (count > 0) {
         //create scope
         Nan::HandleScope scope;
 
         for (std::size_t i = 0; i < count; i++) {
-            AnyAsyncUpdate *item = (*asyncDeletes)[i];
-
-            //free instance
-            delete item;
+            freeAsyncRecord((*asyncFreeing)[i]);
         }
 
-        assert(count == asyncDeletes->size());
-
-        asyncDeletes->clear();
+        asyncFreeing->clear();
     }
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
 }
 
 /**
@@ -2078,34 +2227,42 @@ void AminoJSEventObject::handleJSUpdates() {
         assert(isMainThread());
     }
 
+    //take items (Note: lock is not held while calling JS)
     int res = pthread_mutex_lock(&asyncLock);
 
     assert(res == 0);
 
-    std::size_t count = jsUpdates->size();
+    jsApplying->swap(*jsUpdates);
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+
+    std::size_t count = jsApplying->size();
 
     if (count > 0) {
         //create scope
         Nan::HandleScope scope;
 
-        for (std::size_t i = 0; i < jsUpdates->size(); i++) {
-            AnyAsyncUpdate *item = (*jsUpdates)[i];
+        for (std::size_t i = 0; i < count; i++) {
+            AnyAsyncUpdate *item = (*jsApplying)[i];
 
             item->apply();
             delete item;
         }
 
-        jsUpdates->clear();
+        jsApplying->clear();
     }
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
 }
 
 /**
  * Get runtime specific data.
  */
 void AminoJSEventObject::getStats(v8::Local<v8::Object> &obj) {
+    //property updates
+    Nan::Set(obj, Nan::New("updatesSubmitted").ToLocalChecked(), Nan::New(updatesSubmitted.load()));
+    Nan::Set(obj, Nan::New("updatesApplied").ToLocalChecked(), Nan::New(updatesApplied.load()));
+    Nan::Set(obj, Nan::New("updatesRejected").ToLocalChecked(), Nan::New(updatesRejected));
+
     //internal
 
     /*
@@ -2175,80 +2332,246 @@ void AminoJSEventObject::processAsyncQueue() {
         printf("--- processAsyncQueue() --- \n");
     }
 
-    //iterate
+    //take locked updates
     assert(asyncUpdates);
 
     int res = pthread_mutex_lock(&asyncLock);
 
     assert(res == 0);
 
-    for (std::size_t i = 0; i < asyncUpdates->size(); i++) {
-        AnyAsyncUpdate *item = (*asyncUpdates)[i];
-
-        assert(item);
+    //Note: main thread does not use the ring while overflowing (ring items are older)
+    uint32_t head = asyncRingHead.load(std::memory_order_acquire);
 
-        //debug
-        //printf("%i of %i (type: %i)\n", (int)i, (int)asyncUpdates->size(), (int)item->type);
+    asyncPending->swap(*asyncUpdates);
+    asyncOverflow.store(false, std::memory_order_release);
 
-        switch (item->type) {
-            case ASYNC_UPDATE_PROPERTY:
-                //property update
-                {
-                    AsyncPropertyUpdate *propItem = static_cast<AsyncPropertyUpdate *>(item);
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
 
-                    //call local handler
-                    assert(propItem->property);
-                    assert(propItem->property->obj);
+    //collect batch (ring items first)
+    uint32_t tail = asyncRingTail.load(std::memory_order_relaxed);
 
-                    if (DEBUG_ASYNC) {
-                        printf("%i of %i (property: %s of %s)\n", (int)i, (int)asyncUpdates->size(), propItem->property->name.c_str(), propItem->property->obj->getName().c_str());
-                    }
+    if (DEBUG_ASYNC) {
+        printf("async updates: %i (queued: %i)\n", (int)(head - tail), (int)asyncPending->size());
+    }
 
-                    propItem->property->obj->handleAsyncUpdate(propItem);
-                }
-                break;
+    while (tail != head) {
+        asyncApplied->push_back(asyncRing[tail & (ASYNC_QUEUE_SIZE - 1)]);
 
-            case ASYNC_UPDATE_VALUE:
-                //custom value update
-                {
-                    AsyncValueUpdate *valueItem = static_cast<AsyncValueUpdate *>(item);
+        //release slot
+        tail++;
+        asyncRingTail.store(tail, std::memory_order_release);
+    }
 
-                    //call local handler
-                    assert(valueItem->obj);
+    asyncApplied->insert(asyncApplied->end(), asyncPending->begin(), asyncPending->end());
+    asyncPending->clear();
 
-                    if (DEBUG_ASYNC) {
-                        printf("%i of %i (type: value update)\n", (int)i, (int)asyncUpdates->size());
-                    }
+    //coalesce property updates
+    coalesceAsyncRecords();
 
-                    if (!valueItem->obj->handleAsyncUpdate(valueItem)) {
-                        std::string name = valueItem->obj->getName();
+    //apply without holding the lock
+    std::size_t count = asyncApplied->size();
 
-                        printf("unhandled async update by %s\n", name.c_str());
-                    }
-                }
-                break;
+    for (std::size_t i = 0; i < count; i++) {
+        async_record_t &record = (*asyncApplied)[i];
 
-            default:
-                printf("unknown async type: %i\n", item->type);
-                assert(false);
-                break;
+        if (record.coalesced) {
+            continue;
         }
 
-        //free item
-        asyncDeletes->push_back(item);
+        applyAsyncRecord(record);
+
+        if (record.property) {
+            updatesApplied++;
+        }
     }
 
-    //clear
-    asyncUpdates->clear();
+    //free items on main thread
+    if (!asyncApplied->empty()) {
+        res = pthread_mutex_lock(&asyncLock);
+        assert(res == 0);
 
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+        asyncDeletes->insert(asyncDeletes->end(), asyncApplied->begin(), asyncApplied->end());
+
+        res = pthread_mutex_unlock(&asyncLock);
+        assert(res == 0);
+
+        asyncApplied->clear();
+    }
 
     if (DEBUG_BASE) {
         printf("--- processAsyncQueue() done --- \n");
     }
 }
 
+/**
+ * Skip property updates which are overwritten later in the same batch.
+ *
+ * Note: value updates are never skipped and keep their order with the property updates around them.
+ */
+void AminoJSEventObject::coalesceAsyncRecords() {
+    std::size_t count = asyncApplied->size();
+
+    if (count < 2) {
+        return;
+    }
+
+    //iterate backwards (first occurrence is the last value)
+    uint32_t stamp = ++asyncStamp;
+
+    for (std::size_t i = count; i > 0; i--) {
+        async_record_t &record = (*asyncApplied)[i - 1];
+        AnyProperty *property = record.property;
+
+        if (!property) {
+            //value update: new segment
+            stamp = ++asyncStamp;
+            continue;
+        }
+
+        if (property->asyncStamp == stamp) {
+            //overwritten by a later update
+            record.coalesced = true;
+        } else {
+            property->asyncStamp = stamp;
+        }
+    }
+}
+
+/**
+ * Apply a queued update.
+ *
+ * Note: runs on rendering thread.
+ */
+void AminoJSEventObject::applyAsyncRecord(async_record_t &record) {
+    if (record.property) {
+        //property update
+        AnyProperty *property = record.property;
+
+        //call local handler
+        assert(property->obj);
+
+        if (DEBUG_ASYNC) {
+            printf("-> property: %s of %s\n", property->name.c_str(), property->obj->getName().c_str());
+        }
+
+        AsyncPropertyUpdate update(property, record.value);
+
+        property->obj->handleAsyncUpdate(&update);
+
+        //keep references for main thread
+        record.retainLater = update.retainLater;
+        record.releaseLater = update.releaseLater;
+
+        return;
+    }
+
+    AnyAsyncUpdate *item = record.value.update;
+
+    assert(item);
+
+    switch (item->type) {
+        case ASYNC_UPDATE_VALUE:
+            //custom value update
+            {
+                AsyncValueUpdate *valueItem = static_cast<AsyncValueUpdate *>(item);
+
+                //call local handler
+                assert(valueItem->obj);
+
+                if (DEBUG_ASYNC) {
+                    printf("-> value update\n");
+                }
+
+                if (!valueItem->obj->handleAsyncUpdate(valueItem)) {
+                    std::string name = valueItem->obj->getName();
+
+                    printf("unhandled async update by %s\n", name.c_str());
+                }
+            }
+            break;
+
+        default:
+            printf("unknown async type: %i\n", item->type);
+            assert(false);
+            break;
+    }
+}
+
+/**
+ * Free a queued update.
+ *
+ * Note: called on main thread.
+ */
+void AminoJSEventObject::freeAsyncRecord(async_record_t &record) {
+    AnyProperty *property = record.property;
+
+    if (!property) {
+        //value update
+        delete record.value.update;
+
+        return;
+    }
+
+    //retain/release
+    if (record.retainLater) {
+        record.retainLater->retain();
+    }
+
+    if (record.releaseLater) {
+        record.releaseLater->release();
+    }
+
+    //free data
+    property->freeAsyncData(record.value);
+
+    //release instance to target object
+    property->release();
+}
+
+/**
+ * Add a queued update.
+ *
+ * Note: uses the lock-free queue on the main thread, falls back to the locked queue if full or called on another thread.
+ */
+void AminoJSEventObject::enqueueAsyncRecord(async_record_t &record) {
+    bool overflow = false;
+
+    if (isMainThread()) {
+        if (!asyncOverflow.load(std::memory_order_acquire)) {
+            uint32_t head = asyncRingHead.load(std::memory_order_relaxed);
+
+            if (head - asyncRingTail.load(std::memory_order_acquire) < ASYNC_QUEUE_SIZE) {
+                asyncRing[head & (ASYNC_QUEUE_SIZE - 1)] = record;
+                asyncRingHead.store(head + 1, std::memory_order_release);
+
+                return;
+            }
+
+            //full
+            if (DEBUG_ASYNC) {
+                printf("async queue full\n");
+            }
+        }
+
+        overflow = true;
+    }
+
+    int res = pthread_mutex_lock(&asyncLock);
+
+    assert(res == 0);
+
+    //keep order: use locked queue until processed
+    if (overflow) {
+        asyncOverflow = true;
+    }
+
+    asyncUpdates->push_back(record);
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+}
+
 /**
  * Enqueue a value update.
  */
@@ -2267,16 +2590,17 @@ bool AminoJSEventObject::enqueueValueUpdate(AsyncValueUpdate *update) {
         printf("enqueueValueUpdate\n");
     }
 
-    assert(asyncUpdates);
+    async_record_t record;
 
-    int res = pthread_mutex_lock(&asyncLock);
+    record.property = NULL;
+    record.value.update = update;
+    record.retainLater = NULL;
+    record.releaseLater = NULL;
+    record.coalesced = false;
 
-    assert(res == 0);
+    enqueueAsyncRecord(record);
 
-    asyncUpdates->push_back(update);
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+    notifyUpdate();
 
     return true;
 }
@@ -2294,10 +2618,11 @@ bool AminoJSEventObject::enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::
     assert(prop);
 
     //create
-    bool valid = false;
-    void *data = prop->getAsyncData(value, valid);
+    async_value_t data;
+
+    data.ptr = NULL;
 
-    if (!valid) {
+    if (!prop->getAsyncData(value, data)) {
         return false;
     }
 
@@ -2317,25 +2642,365 @@ bool AminoJSEventObject::enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::
     }
 
     //async handling
+    async_record_t record;
+
+    record.property = prop;
+    record.value = data;
+    record.retainLater = NULL;
+    record.releaseLater = NULL;
+    record.coalesced = false;
+
+    //retain instance to target object (released on main thread)
+    prop->retain();
+
+    enqueueAsyncRecord(record);
+    updatesSubmitted++;
+
+    notifyUpdate();
+
+    return true;
+}
+
+/**
+ * Check if a packed value is a valid uint32 (e.g. object or property id).
+ */
+static bool is_uint32_value(double value) {
+    return std::isfinite(value) && value >= 0 && value <= UINT32_MAX && value == std::floor(value);
+}
+
+/**
+ * Enqueue packed property updates (object id, property id, value).
+ *
+ * Note: called on main thread. The JS values are updated without calling the watchers.
+ */
+uint32_t AminoJSEventObject::enqueuePropertyUpdates(double *data, std::size_t count) {
+    if (destroyed) {
+        return 0;
+    }
+
+    uint32_t updated = 0;
+
+    for (std::size_t i = 0; i < count; i++) {
+        double *item = data + i * 3;
+
+        //validate ids
+        if (!is_uint32_value(item[0]) || !is_uint32_value(item[1])) {
+            updatesRejected++;
+            continue;
+        }
+
+        //object
+        std::map<uint32_t, AminoJSObject *>::iterator it = objectMap.find((uint32_t)item[0]);
+
+        if (it == objectMap.end()) {
+            if (DEBUG_BASE) {
+                printf("-> unknown object: %i\n", (int)item[0]);
+            }
+
+            continue;
+        }
+
+        AminoJSObject *obj = it->second;
+        AnyProperty *prop = obj->getPropertyWithId((uint32_t)item[1]);
+
+        if (!prop) {
+            continue;
+        }
+
+        //value
+        double value = item[2];
+        async_value_t asyncValue;
+        v8::Local<v8::Value> jsValue;
+
+        bool valid = true;
+
+        switch (prop->type) {
+            case PROPERTY_FLOAT:
+                //Note: NaN and infinity are kept (same as JS setter)
+                if (std::isfinite(value) && std::fabs(value) > FLT_MAX) {
+                    valid = false;
+                    break;
+                }
+
+                asyncValue.f = value;
+                jsValue = Nan::New<v8::Number>(value);
+                break;
+
+            case PROPERTY_DOUBLE:
+                asyncValue.d = value;
+                jsValue = Nan::New<v8::Number>(value);
+                break;
+
+            case PROPERTY_INT32:
+                if (!std::isfinite(value) || value < INT32_MIN || value > INT32_MAX) {
+                    valid = false;
+                    break;
+                }
+
+                asyncValue.i32 = value;
+                jsValue = Nan::New<v8::Number>(asyncValue.i32);
+                break;
+
+            case PROPERTY_UINT32:
+                if (!std::isfinite(value) || value < 0 || value > UINT32_MAX) {
+                    valid = false;
+                    break;
+                }
+
+                asyncValue.u32 = value;
+                jsValue = Nan::New<v8::Number>(asyncValue.u32);
+                break;
+
+            case PROPERTY_BOOLEAN:
+                asyncValue.b = value != 0 && !std::isnan(value);
+                jsValue = Nan::New<v8::Boolean>(asyncValue.b);
+                break;
+
+            default:
+                //not a scalar
+                valid = false;
+                break;
+        }
+
+        if (!valid) {
+            if (DEBUG_BASE) {
+                printf("-> invalid value: %f (property %s)\n", value, prop->name.c_str());
+            }
+
+            updatesRejected++;
+            continue;
+        }
+
+        //update JS value
+        Nan::MaybeLocal<v8::Value> maybeProp = Nan::Get(obj->handle(), Nan::New<v8::String>(prop->name).ToLocalChecked());
+
+        if (!maybeProp.IsEmpty() && maybeProp.ToLocalChecked()->IsFunction()) {
+            Nan::Set(maybeProp.ToLocalChecked().As<v8::Object>(), Nan::New<v8::String>("value").ToLocalChecked(), jsValue);
+        }
+
+        updated++;
+
+        //call sync handler
+        if (obj->handleSyncUpdate(prop, asyncValue)) {
+            continue;
+        }
+
+        //async handling
+        async_record_t record;
+
+        record.property = prop;
+        record.value = asyncValue;
+        record.retainLater = NULL;
+        record.releaseLater = NULL;
+        record.coalesced = false;
+
+        //retain instance to target object (released on main thread)
+        prop->retain();
+
+        asyncBulk->push_back(record);
+    }
+
+    if (asyncBulk->empty()) {
+        return updated;
+    }
+
+    //enqueue in one step
     int res = pthread_mutex_lock(&asyncLock);
 
     assert(res == 0);
 
-    asyncUpdates->push_back(new AsyncPropertyUpdate(prop, data));
+    //keep order: use locked queue until processed
+    asyncOverflow = true;
+    asyncUpdates->insert(asyncUpdates->end(), asyncBulk->begin(), asyncBulk->end());
 
     res = pthread_mutex_unlock(&asyncLock);
     assert(res == 0);
 
-    return true;
+    updatesSubmitted += (uint32_t)asyncBulk->size();
+    asyncBulk->clear();
+
+    notifyUpdate();
+
+    return updated;
+}
+
+/**
+ * Register object for bulk updates.
+ *
+ * Note: called on main thread.
+ */
+void AminoJSEventObject::registerObject(AminoJSObject *obj) {
+    objectMap[obj->getObjectId()] = obj;
+}
+
+/**
+ * Unregister object.
+ *
+ * Note: called on main thread.
+ */
+void AminoJSEventObject::unregisterObject(AminoJSObject *obj) {
+    objectMap.erase(obj->getObjectId());
 }
 
 /**
  * Add JS property update.
  */
 bool AminoJSEventObject::enqueueJSPropertyUpdate(AnyProperty *prop) {
+    assert(prop);
+
+    if (destroyed) {
+        return false;
+    }
+
+    //check policy
+    if (prop->notifyMode == NOTIFY_END) {
+        return true;
+    }
+
+    //collect (sent by flushJSPropertyUpdates())
+    int res = pthread_mutex_lock(&asyncLock);
+
+    assert(res == 0);
+
+    if (!prop->notifyPending) {
+        prop->notifyPending = true;
+        jsPending->push_back(prop);
+    }
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+
+    return true;
+}
+
+/**
+ * Send the final property value (e.g. end of animation).
+ *
+ * Note: bypasses the notification policy and keeps the order with following JS updates.
+ */
+bool AminoJSEventObject::enqueueJSPropertyEnd(AnyProperty *prop) {
+    assert(prop);
+
+    if (destroyed) {
+        return false;
+    }
+
+    int res = pthread_mutex_lock(&asyncLock);
+
+    assert(res == 0);
+
+    //skip pending notification
+    prop->notifyPending = false;
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+
     return enqueueJSUpdate(new JSPropertyUpdate(prop));
 }
 
+/**
+ * Remove pending JS notifications of an object.
+ *
+ * Note: called on main thread.
+ */
+void AminoJSEventObject::removeJSPropertyUpdates(AminoJSObject *obj) {
+    int res = pthread_mutex_lock(&asyncLock);
+
+    assert(res == 0);
+
+    std::size_t count = jsPending->size();
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < count; i++) {
+        AnyProperty *prop = (*jsPending)[i];
+
+        if (prop->obj == obj) {
+            prop->notifyPending = false;
+        } else {
+            (*jsPending)[kept++] = prop;
+        }
+    }
+
+    jsPending->resize(kept);
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+}
+
+/**
+ * Send collected property changes to JS.
+ *
+ * Note: called once per frame on rendering thread. Numeric values are sent as a single batch.
+ */
+void AminoJSEventObject::flushJSPropertyUpdates(double time) {
+    int res = pthread_mutex_lock(&asyncLock);
+
+    assert(res == 0);
+
+    std::size_t count = jsPending->size();
+    std::size_t kept = 0;
+    JSPropertyBatchUpdate *batch = NULL;
+
+    for (std::size_t i = 0; i < count; i++) {
+        AnyProperty *prop = (*jsPending)[i];
+
+        if (!prop->notifyPending) {
+            //already sent
+            continue;
+        }
+
+        //throttling
+        if (prop->notifyMode == NOTIFY_THROTTLE && time - prop->lastNotify < prop->notifyInterval) {
+            (*jsPending)[kept++] = prop;
+            continue;
+        }
+
+        prop->notifyPending = false;
+        prop->lastNotify = time;
+
+        //numeric value
+        double value;
+
+        switch (prop->type) {
+            case PROPERTY_FLOAT:
+                value = static_cast<FloatProperty *>(prop)->value;
+                break;
+
+            case PROPERTY_DOUBLE:
+                value = static_cast<DoubleProperty *>(prop)->value;
+                break;
+
+            case PROPERTY_INT32:
+                value = static_cast<Int32Property *>(prop)->value;
+                break;
+
+            case PROPERTY_UINT32:
+                value = static_cast<UInt32Property *>(prop)->value;
+                break;
+
+            default:
+                //other types
+                jsUpdates->push_back(new JSPropertyUpdate(prop));
+                continue;
+        }
+
+        if (!batch) {
+            batch = new JSPropertyBatchUpdate(this);
+        }
+
+        batch->add(prop, value);
+    }
+
+    jsPending->resize(kept);
+
+    if (batch) {
+        jsUpdates->push_back(batch);
+    }
+
+    res = pthread_mutex_unlock(&asyncLock);
+    assert(res == 0);
+}
+
 /**
  * Add JS update to run on main thread.
  */
@@ -2360,41 +3025,35 @@ bool AminoJSEventObject::enqueueJSUpdate(AnyAsyncUpdate *update) {
     return true;
 }
 
+/**
+ * New async update is available.
+ *
+ * Note: overwrite to wake up the consumer thread.
+ */
+void AminoJSEventObject::notifyUpdate() {
+    //empty
+}
+
 //
 // AminoJSEventObject::AsyncPropertyUpdate
 //
 
 /**
  * Constructor.
+ *
+ * Note: created on rendering thread while applying a queued update.
  */
-AminoJSEventObject::AsyncPropertyUpdate::AsyncPropertyUpdate(AnyProperty *property, void *data): AnyAsyncUpdate(ASYNC_UPDATE_PROPERTY), property(property), data(data) {
+AminoJSEventObject::AsyncPropertyUpdate::AsyncPropertyUpdate(AnyProperty *property, async_value_t &data): AnyAsyncUpdate(ASYNC_UPDATE_PROPERTY), property(property), data(data) {
     assert(property);
-
-    //retain instance to target object
-    property->retain();
 }
 
 /**
  * Destructor.
  *
- * Note: called on main thread.
+ * Note: references and data are freed by the queue on main thread.
  */
 AminoJSEventObject::AsyncPropertyUpdate::~AsyncPropertyUpdate() {
-    //retain/release
-    if (retainLater) {
-        retainLater->retain();
-    }
-
-    if (releaseLater) {
-        releaseLater->release();
-    }
-
-    //free data
-    property->freeAsyncData(data);
-    data = NULL;
-
-    //release instance to target object
-    property->release();
+    //empty
 }
 
 /**
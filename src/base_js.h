@@ -7,14 +7,19 @@
 
 #include <map>
 #include <memory>
+#include <atomic>
 #include <pthread.h>
 
 #define ASYNC_UPDATE_PROPERTY      0
 #define ASYNC_UPDATE_VALUE         1
 #define ASYNC_JS_UPDATE_PROPERTY  10
 #define ASYNC_JS_UPDATE_CALLBACK  11
+#define ASYNC_JS_UPDATE_BATCH     12
 #define ASYNC_UPDATE_CUSTOM      100
 
+//lock-free queue size (power of two)
+#define ASYNC_QUEUE_SIZE 4096
+
 #define DEBUG_BASE false
 
 #define DEBUG_THREADS false
@@ -48,10 +53,12 @@ protected:
     std::string name;
     AminoJSEventObject *eventHandler = NULL;
     bool destroyed = false;
+    uint32_t objectId;
 
     //stats
     static uint32_t activeInstances;
     static uint32_t totalInstances;
+    static uint32_t lastObjectId;
     static std::vector<AminoJSObject *> jsInstances;
 
     AminoJSObject(std::string name);
@@ -78,8 +85,27 @@ protected:
     static const int32_t PROPERTY_UTF8         = 8;
     static const int32_t PROPERTY_OBJECT       = 9;
 
+    //JS notification policy (changes on rendering thread)
+    static const int32_t NOTIFY_FRAME    = 0; //every frame
+    static const int32_t NOTIFY_THROTTLE = 1; //max rate
+    static const int32_t NOTIFY_END      = 2; //end of animation
+
+    class AnyAsyncUpdate;
     class AsyncPropertyUpdate;
 
+    /**
+     * Async value (scalars are stored inline, other values as side allocation).
+     */
+    typedef union {
+        float f;
+        double d;
+        int32_t i32;
+        uint32_t u32;
+        bool b;
+        void *ptr;
+        AnyAsyncUpdate *update;
+    } async_value_t;
+
     class AnyProperty {
     public:
         int32_t type;
@@ -97,13 +123,22 @@ protected:
         virtual v8::Local<v8::Value> toValue() = 0;
 
         //async handling
-        virtual void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) = 0;
-        virtual void setAsyncData(AsyncPropertyUpdate *update, void *data) = 0;
-        virtual void freeAsyncData(void *data) = 0;
+        virtual bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) = 0;
+        virtual void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) = 0;
+        virtual void freeAsyncData(async_value_t &data);
 
         //weak reference control (obj)
         void retain();
         void release();
+
+        //coalescing (rendering thread)
+        uint32_t asyncStamp = 0;
+
+        //JS notification (policy set on main thread)
+        std::atomic<int32_t> notifyMode;
+        std::atomic<double> notifyInterval; //ms
+        double lastNotify = 0;
+        bool notifyPending = false;
     };
 
     class FloatProperty : public AnyProperty {
@@ -121,29 +156,47 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
     };
 
+    /**
+     * Float array async data (shared typed array memory or copied values).
+     */
+    typedef struct {
+        std::shared_ptr<v8::BackingStore> store;
+        float *data;
+        std::size_t count;
+        std::vector<float> vector;
+    } float_array_data_t;
+
     class FloatArrayProperty : public AnyProperty {
     public:
         std::vector<float> value;
 
+        //typed array memory (zero-copy, used instead of value)
+        std::shared_ptr<v8::BackingStore> store;
+        float *storeData = NULL;
+        std::size_t storeCount = 0;
+
         FloatArrayProperty(AminoJSObject *obj, std::string name, uint32_t id);
         ~FloatArrayProperty();
 
         void setValue(std::vector<float> newValue);
 
+        float* getData();
+        std::size_t getSize();
+        bool isEmpty();
+
         std::string toString() override;
 
         //sync handling
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
+        void freeAsyncData(async_value_t &data) override;
     };
 
     class DoubleProperty : public AnyProperty {
@@ -161,9 +214,8 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
     };
 
     class UShortArrayProperty : public AnyProperty {
@@ -181,9 +233,9 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
+        void freeAsyncData(async_value_t &data) override;
     };
 
     class Int32Property : public AnyProperty {
@@ -201,9 +253,8 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
     };
 
     class UInt32Property : public AnyProperty {
@@ -221,9 +272,8 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
     };
 
     class BooleanProperty : public AnyProperty {
@@ -241,9 +291,8 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
     };
 
     class Utf8Property : public AnyProperty {
@@ -262,9 +311,9 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
+        void freeAsyncData(async_value_t &data) override;
     };
 
     class ObjectProperty : public AnyProperty {
@@ -284,9 +333,9 @@ protected:
         v8::Local<v8::Value> toValue() override;
 
         //async handling
-        void* getAsyncData(v8::Local<v8::Value> &value, bool &valid) override;
-        void setAsyncData(AsyncPropertyUpdate *update, void *data) override;
-        void freeAsyncData(void *data) override;
+        bool getAsyncData(v8::Local<v8::Value> &value, async_value_t &data) override;
+        void setAsyncData(AsyncPropertyUpdate *update, async_value_t &data) override;
+        void freeAsyncData(async_value_t &data) override;
     };
 
     void updateProperty(AnyProperty *property);
@@ -319,13 +368,13 @@ protected:
     class AsyncPropertyUpdate : public AnyAsyncUpdate {
     public:
         AnyProperty *property;
-        void *data;
+        async_value_t data;
 
         //helpers
         AminoJSObject *retainLater = NULL;
         AminoJSObject *releaseLater = NULL;
 
-        AsyncPropertyUpdate(AnyProperty *property, void *data);
+        AsyncPropertyUpdate(AnyProperty *property, async_value_t &data);
         ~AsyncPropertyUpdate();
 
         void apply();
@@ -377,6 +426,19 @@ protected:
         AnyProperty *property;
     };
 
+    class JSPropertyBatchUpdate: public AnyAsyncUpdate {
+    public:
+        JSPropertyBatchUpdate(AminoJSObject *obj);
+        ~JSPropertyBatchUpdate();
+
+        void add(AnyProperty *property, double value);
+        void apply() override;
+    private:
+        AminoJSObject *obj;
+        std::vector<AnyProperty *> properties;
+        std::vector<double> values;
+    };
+
     class JSCallbackUpdate;
     typedef void (AminoJSObject::*jsUpdateCallback)(JSCallbackUpdate *);
 
@@ -410,6 +472,7 @@ private:
     //async updates
     bool enqueuePropertyUpdate(uint32_t id, v8::Local<v8::Value> &value);
     static NAN_METHOD(PropertyUpdated);
+    static NAN_METHOD(SetPropertyNotify);
     static Nan::Persistent<v8::Function> *propertyUpdatedFunc;
 
     //JS updates
@@ -417,6 +480,7 @@ private:
 
 public:
     std::string getName();
+    uint32_t getObjectId();
 
     void retain();
     void release();
@@ -427,7 +491,7 @@ public:
 
     virtual AminoJSEventObject* getEventHandler();
 
-    virtual bool handleSyncUpdate(AnyProperty *property, void *data);
+    virtual bool handleSyncUpdate(AnyProperty *property, async_value_t &data);
     virtual void handleAsyncUpdate(AsyncPropertyUpdate *update);
     virtual bool handleAsyncUpdate(AsyncValueUpdate *update);
 };
@@ -443,10 +507,17 @@ public:
     AminoJSEventObject* getEventHandler() override;
 
     bool enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::Value> &value);
+    uint32_t enqueuePropertyUpdates(double *data, std::size_t count);
     bool enqueueValueUpdate(AsyncValueUpdate *update) override;
 
+    void registerObject(AminoJSObject *obj);
+    void unregisterObject(AminoJSObject *obj);
+
     bool enqueueJSPropertyUpdate(AnyProperty *prop) override;
+    bool enqueueJSPropertyEnd(AnyProperty *prop);
+    void removeJSPropertyUpdates(AminoJSObject *obj);
     bool enqueueJSUpdate(AnyAsyncUpdate *update);
+    virtual void notifyUpdate();
 
     bool isMainThread();
 
@@ -456,16 +527,63 @@ protected:
     void clearAsyncQueue();
     void handleAsyncDeletes();
     void handleJSUpdates();
+    void flushJSPropertyUpdates(double time);
 
     virtual void getStats(v8::Local<v8::Object> &obj);
 
 private:
-    std::vector<AnyAsyncUpdate *> *asyncUpdates = NULL;
-    std::vector<AnyAsyncUpdate *> *asyncDeletes = NULL;
+    /**
+     * Queued async update (fixed size).
+     */
+    typedef struct {
+        AnyProperty *property; //NULL for value updates
+        async_value_t value;
+
+        //main thread references (set while applying)
+        AminoJSObject *retainLater;
+        AminoJSObject *releaseLater;
+
+        //overwritten by a later update
+        bool coalesced;
+    } async_record_t;
+
+    //lock-free queue (main thread -> rendering thread)
+    async_record_t *asyncRing = NULL;
+    std::atomic<uint32_t> asyncRingHead; //written by main thread
+    std::atomic<uint32_t> asyncRingTail; //written by rendering thread
+    std::atomic<bool> asyncOverflow;
+
+    //locked queues
+    std::vector<async_record_t> *asyncUpdates = NULL;
+    std::vector<async_record_t> *asyncDeletes = NULL;
     std::vector<AnyAsyncUpdate *> *jsUpdates = NULL;
+    std::vector<AnyProperty *> *jsPending = NULL;
+
+    //swap buffers (owned by a single thread)
+    std::vector<async_record_t> *asyncPending = NULL;
+    std::vector<async_record_t> *asyncApplied = NULL;
+    std::vector<async_record_t> *asyncFreeing = NULL;
+    std::vector<AnyAsyncUpdate *> *jsApplying = NULL;
+    std::vector<async_record_t> *asyncBulk = NULL;
+
+    //objects (main thread)
+    std::map<uint32_t, AminoJSObject *> objectMap;
 
     uv_thread_t mainThread;
-    pthread_mutex_t asyncLock; //Note: can block for a while
+    pthread_mutex_t asyncLock; //Note: only held for short queue operations
+
+    //coalescing (rendering thread)
+    uint32_t asyncStamp = 0;
+
+    //stats
+    std::atomic<uint32_t> updatesSubmitted;
+    std::atomic<uint32_t> updatesApplied; //Note: written by rendering thread
+    uint32_t updatesRejected = 0; //invalid packed updates
+
+    void enqueueAsyncRecord(async_record_t &record);
+    void coalesceAsyncRecords();
+    void applyAsyncRecord(async_record_t &record);
+    void freeAsyncRecord(async_record_t &record);
 };
 
 #endif
@@ -5,9 +5,18 @@
 #include "base.h"
 
 #include <cmath>
+#include <algorithm>
 
 #define DEBUG_FONTS false
 
+//glyphs rendered per lock (pre-warming)
+#define LOAD_GLYPHS_CHUNK 16
+
+//atlas pages (first page is 512x512, next pages double in size)
+#define ATLAS_INITIAL_SIZE 512
+#define ATLAS_MAX_SIZE 2048
+#define ATLAS_MAX_PAGES 4
+
 //
 // AminoFonts
 //
@@ -80,13 +89,17 @@ AminoJSObject* AminoFontsFactory::create() {
 //
 
 AminoFont::AminoFont(): AminoJSObject(getFactory()->name) {
-    //empty
+    int res = uv_mutex_init(&glyphMutex);
+
+    assert(res == 0);
 }
 
 AminoFont::~AminoFont() {
     if (!destroyed) {
         destroyAminoFont();
     }
+
+    uv_mutex_destroy(&glyphMutex);
 }
 
 /**
@@ -108,8 +121,11 @@ void AminoFont::destroy() {
  * Destroy font data.
  */
 void AminoFont::destroyAminoFont() {
+    lockGlyphs();
+
     //font sizes
     for (std::map<uint32_t, texture_font_t *>::iterator it = fontSizes.begin(); it != fontSizes.end(); it++) {
+        AminoTextCache::getInstance()->remove(it->second);
         texture_font_delete(it->second);
     }
 
@@ -121,6 +137,14 @@ void AminoFont::destroyAminoFont() {
         atlas = NULL;
     }
 
+    //cache (after the atlas pages using the mapped file)
+    if (cache) {
+        delete cache;
+        cache = NULL;
+    }
+
+    unlockGlyphs();
+
     //font data
     fontData.Reset();
 }
@@ -144,7 +168,8 @@ AminoFontFactory* AminoFont::getFactory() {
 v8::Local<v8::FunctionTemplate> AminoFont::GetInitFunction() {
     v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
 
-    //no methods
+    //methods
+    Nan::SetPrototypeMethod(tpl, "_saveCache", SaveCache);
 
     //template function
     return tpl;
@@ -176,13 +201,31 @@ void AminoFont::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
     this->fontData.Reset(bufferObj);
 
     //create atlas
-    atlas = texture_atlas_new(512, 512, 1); //depth must be 1
+    atlas = texture_atlas_new(ATLAS_INITIAL_SIZE, ATLAS_INITIAL_SIZE, 1); //depth must be 1
 
     if (!atlas) {
         Nan::ThrowError("could not create atlas");
         return;
     }
 
+    //grow (evicts least recently used page if all pages are full)
+    atlas->max_size = std::max(maxAtlasSize, ATLAS_INITIAL_SIZE);
+    atlas->max_pages = ATLAS_MAX_PAGES;
+    atlas->user_data = this;
+
+    //distance field glyphs (optional)
+    v8::Local<v8::Value> sdfValue = Nan::Get(fontData, Nan::New<v8::String>("sdf").ToLocalChecked()).ToLocalChecked();
+
+    sdf = Nan::To<v8::Boolean>(sdfValue).ToLocalChecked()->Value();
+
+    //glyph cache (optional)
+    v8::Local<v8::Value> cacheDirValue = Nan::Get(fontData, Nan::New<v8::String>("cacheDir").ToLocalChecked()).ToLocalChecked();
+
+    if (cacheDirValue->IsString()) {
+        cache = new AminoFontCache(AminoJSObject::toString(cacheDirValue), node::Buffer::Data(bufferObj), node::Buffer::Length(bufferObj), atlas, sdf ? RENDER_SIGNED_DISTANCE_FIELD:RENDER_NORMAL);
+        cache->restoreAtlas(atlas);
+    }
+
     //metadata
     v8::Local<v8::Value> nameValue = Nan::Get(fontData, Nan::New<v8::String>("name").ToLocalChecked()).ToLocalChecked();
     v8::Local<v8::Value> styleValue = Nan::Get(fontData, Nan::New<v8::String>("style").ToLocalChecked()).ToLocalChecked();
@@ -192,16 +235,20 @@ void AminoFont::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
     fontStyle = AminoJSObject::toString(styleValue);
 
     if (DEBUG_FONTS) {
-        printf("-> new font: name=%s, style=%s, weight=%i\n", fontName.c_str(), fontStyle.c_str(), fontWeight);
+        printf("-> new font: name=%s, style=%s, weight=%i, sdf=%i\n", fontName.c_str(), fontStyle.c_str(), fontWeight, sdf);
     }
 }
 
 /**
  * Load font size.
  *
- * Note: has to be called in v8 thread.
+ * Note: has to be called in v8 thread. Distance field fonts use the same glyphs for all sizes.
  */
 texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
+    if (sdf) {
+        size = SDF_FONT_SIZE;
+    }
+
     //check cache
     std::map<uint32_t, texture_font_t *>::iterator it = fontSizes.find(size);
     texture_font_t *fontSize;
@@ -213,8 +260,21 @@ texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
         size_t bufferLen = node::Buffer::Length(bufferObj);
 
         //Note: has texture id but we use our own handling
+        lockGlyphs();
         fontSize = texture_font_new_from_memory(atlas, size, buffer, bufferLen, library);
 
+        if (fontSize && sdf) {
+            //unhinted outlines (scaled)
+            fontSize->rendermode = RENDER_SIGNED_DISTANCE_FIELD;
+            fontSize->distance_spread = SDF_SPREAD;
+            fontSize->hinting = 0;
+        }
+
+        if (fontSize && cache) {
+            cache->restoreGlyphs(fontSize, size);
+        }
+
+        //Note: insert while locked (saveCache() iterates on worker threads)
         if (fontSize) {
             fontSizes[size] = fontSize;
 
@@ -222,6 +282,8 @@ texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
             library = fontSize->library;
         }
 
+        unlockGlyphs();
+
         if (DEBUG_FONTS) {
             std::string info = getFontInfo();
 
@@ -234,6 +296,34 @@ texture_font_t *AminoFont::getFontWithSize(uint32_t size) {
     return fontSize;
 }
 
+/**
+ * Write the glyph cache (if enabled and glyphs were added).
+ */
+bool AminoFont::saveCache() {
+    if (!cache) {
+        return false;
+    }
+
+    lockGlyphs();
+
+    bool res = cache->save(atlas, fontSizes);
+
+    unlockGlyphs();
+
+    return res;
+}
+
+/**
+ * Write the glyph cache.
+ */
+NAN_METHOD(AminoFont::SaveCache) {
+    AminoFont *obj = Nan::ObjectWrap::Unwrap<AminoFont>(info.This());
+
+    assert(obj);
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(obj->saveCache()));
+}
+
 /**
  * Get Unique font info string.
  */
@@ -241,7 +331,177 @@ std::string AminoFont::getFontInfo() {
     return fontName + "/" + fontStyle + "/" + std::to_string(fontWeight);
 }
 
+/**
+ * Check text layout performance (glyph and kerning lookups of all glyphs in a font file).
+ */
+void AminoFont::checkLayoutPerformance(const char *filename) {
+    const int cycles = 100;
+    double startTime, diff;
+
+    texture_atlas_t *atlas = texture_atlas_new(4096, 4096, 1);
+    texture_font_t *font = texture_font_new_from_file(atlas, 12, filename, NULL);
+
+    if (!font) {
+        printf("could not load font: %s\n", filename);
+        texture_atlas_delete(atlas);
+
+        return;
+    }
+
+    //all characters of the font (UTF-8)
+    std::string text;
+    FT_UInt index;
+    FT_ULong charcode = FT_Get_First_Char(font->face, &index);
+
+    while (index != 0) {
+        if (charcode == 0) {
+            //skip (end of string)
+        } else if (charcode < 0x80) {
+            text += (char)charcode;
+        } else if (charcode < 0x800) {
+            text += (char)(0xC0 | (charcode >> 6));
+            text += (char)(0x80 | (charcode & 0x3F));
+        } else if (charcode < 0x10000) {
+            text += (char)(0xE0 | (charcode >> 12));
+            text += (char)(0x80 | ((charcode >> 6) & 0x3F));
+            text += (char)(0x80 | (charcode & 0x3F));
+        }
+
+        charcode = FT_Get_Next_Char(font->face, charcode, &index);
+    }
+
+    size_t len = utf8_strlen(text.c_str());
+
+    printf("Layout performance: %i characters, %i cycles\n", (int)len, cycles);
+
+    //load glyphs
+    startTime = getTime();
+
+    const char *textPos = text.c_str();
+
+    for (size_t i = 0; i < len; i++) {
+        texture_font_get_glyph(font, textPos);
+        textPos += utf8_surrogate_len(textPos);
+    }
+
+    diff = getTime() - startTime;
+    printf("-> load %i glyphs: %i ms\n", (int)font->glyphs->size, (int)diff);
+
+    //linear glyph scan (previous implementation)
+    float w = 0;
+
+    startTime = getTime();
+
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        textPos = text.c_str();
+
+        for (size_t i = 0; i < len; i++) {
+            uint32_t codepoint = utf8_to_utf32(textPos);
+
+            for (size_t j = 0; j < font->glyphs->size; j++) {
+                texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(font->glyphs, j);
+
+                if (glyph->codepoint == codepoint) {
+                    w += glyph->advance_x;
+                    break;
+                }
+            }
+
+            textPos += utf8_surrogate_len(textPos);
+        }
+    }
+
+    diff = getTime() - startTime;
+    printf("-> linear scan: %i ms\n", (int)diff);
+
+    //glyph index and kerning table
+    startTime = getTime();
+
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        uint32_t last = 0;
+
+        textPos = text.c_str();
+
+        for (size_t i = 0; i < len; i++) {
+            texture_glyph_t *glyph = texture_font_find_glyph(font, textPos);
+
+            if (glyph) {
+                if (i > 0) {
+                    w += texture_font_get_kerning(font, last, glyph->codepoint);
+                }
+
+                w += glyph->advance_x;
+                last = glyph->codepoint;
+            }
+
+            textPos += utf8_surrogate_len(textPos);
+        }
+    }
+
+    diff = getTime() - startTime;
+    printf("-> hash index (incl. kerning): %i ms (%i kerning pairs)\n", (int)diff, (int)font->kerning_map_count);
+
+    //avoid optimizing out the loops
+    if (w < 0) {
+        printf("%f\n", w);
+    }
+
+    //cleanup
+    texture_font_delete(font);
+    texture_atlas_delete(atlas);
+}
+
+/**
+ * Limit the atlas page size to the maximum texture size.
+ *
+ * Note: applies to fonts created afterwards.
+ */
+void AminoFont::setMaxTextureSize(int size) {
+    if (size > 0 && size < maxAtlasSize) {
+        maxAtlasSize = size;
+    }
+}
+
+/**
+ * Lock the glyphs and atlas of all font sizes.
+ *
+ * Note: counts blocked calls.
+ */
+void AminoFont::lockGlyphs() {
+    if (uv_mutex_trylock(&glyphMutex) == 0) {
+        return;
+    }
+
+    lockContention++;
+    uv_mutex_lock(&glyphMutex);
+}
+
+/**
+ * Unlock the glyphs.
+ */
+void AminoFont::unlockGlyphs() {
+    uv_mutex_unlock(&glyphMutex);
+}
+
+/**
+ * Get the font of an atlas (or one of its pages).
+ *
+ * Returns NULL for atlases not owned by a font (e.g. checkLayoutPerformance()); no locking needed.
+ */
+AminoFont* AminoFont::fromAtlas(texture_atlas_t *atlas) {
+    return static_cast<AminoFont *>(atlas->user_data);
+}
+
+/**
+ * Number of blocked glyph locks (all fonts).
+ */
+uint32_t AminoFont::getLockContention() {
+    return lockContention;
+}
+
 FT_Library AminoFont::library = NULL;
+int AminoFont::maxAtlasSize = ATLAS_MAX_SIZE;
+std::atomic<uint32_t> AminoFont::lockContention(0);
 
 //
 //  AminoFontFactory
@@ -294,7 +554,9 @@ v8::Local<v8::FunctionTemplate> AminoFontSize::GetInitFunction() {
 
     //methods
     Nan::SetPrototypeMethod(tpl, "_calcTextWidth", CalcTextWidth);
+    Nan::SetPrototypeMethod(tpl, "_calcTextWidths", CalcTextWidths);
     Nan::SetPrototypeMethod(tpl, "getFontMetrics", GetFontMetrics);
+    Nan::SetPrototypeMethod(tpl, "_loadGlyphs", LoadGlyphs);
 
     //template function
     return tpl;
@@ -323,6 +585,12 @@ void AminoFontSize::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
 
     if (!fontTexture) {
         Nan::ThrowError("could not create font size");
+        return;
+    }
+
+    //scale reference glyphs
+    if (font->sdf) {
+        scale = size / (float)SDF_FONT_SIZE;
     }
 
     //font properties
@@ -348,35 +616,198 @@ NAN_METHOD(AminoFontSize::CalcTextWidth) {
     info.GetReturnValue().Set(obj->getTextWidth(*str));
 }
 
+/**
+ * Calculate the width of multiple texts.
+ *
+ * Parameters:
+ *  - texts: array of strings or a single string
+ *  - breaks: end offsets (in characters) of the segments of a single string (optional)
+ *  - advances: return the advance of each character too (optional)
+ *
+ * Returns a Float32Array with the widths or an object with widths and advances (Float32Array).
+ */
+NAN_METHOD(AminoFontSize::CalcTextWidths) {
+    assert(info.Length() >= 1);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+
+    assert(obj);
+
+    //segments (start, length in characters)
+    std::vector<std::string> texts;
+    std::vector<std::pair<const char *, size_t>> segments;
+    size_t charCount = 0;
+
+    if (info[0]->IsArray()) {
+        //array of strings
+        v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(info[0]);
+        uint32_t count = arr->Length();
+
+        texts.reserve(count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            Nan::Utf8String str(Nan::Get(arr, i).ToLocalChecked());
+
+            texts.push_back(std::string(*str, str.length()));
+        }
+
+        for (auto const &text : texts) {
+            size_t len = utf8_strlen(text.c_str());
+
+            segments.push_back(std::make_pair(text.c_str(), len));
+            charCount += len;
+        }
+    } else {
+        //single string
+        Nan::Utf8String str(info[0]);
+
+        texts.push_back(std::string(*str, str.length()));
+
+        const char *text = texts[0].c_str();
+        size_t len = utf8_strlen(text);
+
+        if (info.Length() > 1 && info[1]->IsArray()) {
+            //break offsets
+            v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(info[1]);
+            uint32_t count = arr->Length();
+            const char *textPos = text;
+            size_t pos = 0;
+
+            for (uint32_t i = 0; i < count; i++) {
+                size_t end = Nan::To<v8::Uint32>(Nan::Get(arr, i).ToLocalChecked()).ToLocalChecked()->Value();
+
+                end = std::min(std::max(end, pos), len);
+
+                segments.push_back(std::make_pair(textPos, end - pos));
+
+                //skip segment
+                for (; pos < end; pos++) {
+                    textPos += utf8_surrogate_len(textPos);
+                }
+            }
+
+            charCount = pos;
+        } else {
+            segments.push_back(std::make_pair(text, len));
+            charCount = len;
+        }
+    }
+
+    //result
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+    size_t count = segments.size();
+    v8::Local<v8::Float32Array> widthArr = v8::Float32Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(float)), 0, count);
+    float *widths = (float *)widthArr->Buffer()->GetBackingStore()->Data();
+    bool withAdvances = info.Length() > 2 && Nan::To<v8::Boolean>(info[2]).ToLocalChecked()->Value();
+    v8::Local<v8::Float32Array> advanceArr;
+    float *advances = NULL;
+
+    if (withAdvances) {
+        advanceArr = v8::Float32Array::New(v8::ArrayBuffer::New(isolate, charCount * sizeof(float)), 0, charCount);
+        advances = (float *)advanceArr->Buffer()->GetBackingStore()->Data();
+    }
+
+    //measure (single lock and atlas update)
+    AminoFont *font = obj->font;
+    texture_font_t *fontTexture = obj->fontTexture;
+    texture_atlas_t *atlas = fontTexture->atlas;
+
+    font->lockGlyphs();
+
+    size_t lastGlyphCount = fontTexture->glyphs->size;
+    size_t lastEvictions = atlas->evictions;
+
+    texture_atlas_lock_used(atlas);
+
+    for (size_t i = 0; i < count; i++) {
+        widths[i] = obj->measureText(segments[i].first, segments[i].second, advances);
+
+        if (advances) {
+            advances += segments[i].second;
+        }
+    }
+
+    bool glyphsChanged = lastGlyphCount != fontTexture->glyphs->size || lastEvictions != atlas->evictions;
+
+    font->unlockGlyphs();
+
+    if (glyphsChanged) {
+        //update all instances
+        AminoGfx::updateAtlasTextures(atlas);
+    }
+
+    if (withAdvances) {
+        v8::Local<v8::Object> res = Nan::New<v8::Object>();
+
+        Nan::Set(res, Nan::New("widths").ToLocalChecked(), widthArr);
+        Nan::Set(res, Nan::New("advances").ToLocalChecked(), advanceArr);
+
+        info.GetReturnValue().Set(res);
+    } else {
+        info.GetReturnValue().Set(widthArr);
+    }
+}
+
 /**
  * Calculate text width.
  */
 float AminoFontSize::getTextWidth(const char *text) {
     size_t len = utf8_strlen(text);
-    char *textPos = (char *)text;
-    char *lastTextPos = NULL;
-    float w = 0;
 
-    AminoText::initFreeTypeMutex();
-    uv_mutex_lock(&AminoText::freeTypeMutex);
+    font->lockGlyphs();
 
+    texture_atlas_t *atlas = fontTexture->atlas;
     size_t lastGlyphCount = fontTexture->glyphs->size;
+    size_t lastEvictions = atlas->evictions;
+
+    texture_atlas_lock_used(atlas);
+
+    float w = measureText(text, len, NULL);
+
+    bool glyphsChanged = lastGlyphCount != fontTexture->glyphs->size || lastEvictions != atlas->evictions;
+
+    font->unlockGlyphs();
+
+    if (glyphsChanged) {
+        //update all instances
+        AminoGfx::updateAtlasTextures(atlas);
+    }
+
+    return w;
+}
+
+/**
+ * Measure the width of a text (and the advance of each character).
+ *
+ * Note: the glyphs of the font have to be locked.
+ */
+float AminoFontSize::measureText(const char *text, size_t len, float *advances) {
+    const char *textPos = text;
+    const char *lastTextPos = NULL;
+    float w = 0;
 
     for (std::size_t i = 0; i < len; i++) {
         texture_glyph_t *glyph = texture_font_get_glyph(fontTexture, textPos);
+        float advance = 0;
 
-        if (!glyph) {
+        if (glyph) {
+            //kerning
+            if (lastTextPos) {
+                advance += texture_font_get_kerning(fontTexture, utf8_to_utf32(lastTextPos), glyph->codepoint);
+            }
+
+            //char width
+            advance += glyph->advance_x;
+        } else {
             printf("Error: got empty glyph from texture_font_get_glyph()\n");
-            continue;
         }
 
-        //kerning
-        if (lastTextPos) {
-            w += texture_glyph_get_kerning(glyph, lastTextPos);
-        }
+        advance *= scale;
+        w += advance;
 
-        //char width
-        w += glyph->advance_x;
+        if (advances) {
+            advances[i] = advance;
+        }
 
         //next
         size_t charLen = utf8_surrogate_len(textPos);
@@ -385,17 +816,6 @@ float AminoFontSize::getTextWidth(const char *text) {
         textPos += charLen;
     }
 
-    bool glyphsChanged = lastGlyphCount != fontTexture->glyphs->size;
-
-    uv_mutex_unlock(&AminoText::freeTypeMutex);
-
-    if (glyphsChanged) {
-        texture_atlas_t *atlas = fontTexture->atlas;
-
-        //update all instances
-        AminoGfx::updateAtlasTextures(atlas);
-    }
-
     return w;
 }
 
@@ -410,9 +830,9 @@ NAN_METHOD(AminoFontSize::GetFontMetrics) {
     //metrics
     v8::Local<v8::Object> metricsObj = Nan::New<v8::Object>();
 
-    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender - obj->fontTexture->descender));
-    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender));
-    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender));
+    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>((obj->fontTexture->ascender - obj->fontTexture->descender) * obj->scale));
+    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender * obj->scale));
+    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender * obj->scale));
 
     info.GetReturnValue().Set(metricsObj);
 }
@@ -435,6 +855,145 @@ AminoJSObject* AminoFontSizeFactory::create() {
     return new AminoFontSize();
 }
 
+//
+// AsyncGlyphWorker
+//
+
+/**
+ * Asynchronous glyph loader (pre-warms the atlas).
+ */
+class AsyncGlyphWorker : public Nan::AsyncWorker {
+private:
+    AminoFontSize *fontSize;
+    std::string codepoints;
+
+    size_t missing = 0;
+    bool glyphsChanged = false;
+
+public:
+    AsyncGlyphWorker(Nan::Callback *callback, v8::Local<v8::Object> &obj, AminoFontSize *fontSize, const char *codepoints) : AsyncWorker(callback) {
+        SaveToPersistent("object", obj);
+
+        this->fontSize = fontSize;
+        this->codepoints = codepoints;
+    }
+
+    /**
+     * Async running code.
+     */
+    void Execute() {
+        AminoFont *font = fontSize->font;
+        texture_font_t *fontTexture = fontSize->fontTexture;
+        texture_atlas_t *atlas = fontTexture->atlas;
+        const char *textPos = codepoints.c_str();
+
+        //render in chunks (layouts using the font are not blocked too long)
+        while (*textPos) {
+            const char *chunkStart = textPos;
+
+            for (int i = 0; i < LOAD_GLYPHS_CHUNK && *textPos; i++) {
+                textPos += utf8_surrogate_len(textPos);
+            }
+
+            std::string chunk(chunkStart, textPos - chunkStart);
+
+            font->lockGlyphs();
+
+            size_t lastGlyphCount = fontTexture->glyphs->size;
+            size_t lastEvictions = atlas->evictions;
+
+            texture_atlas_lock_used(atlas);
+
+            const char *chunkPos = chunk.c_str();
+
+            while (*chunkPos) {
+                size_t left = texture_font_load_glyphs(fontTexture, chunkPos);
+
+                if (left == 0) {
+                    break;
+                }
+
+                //skip glyph which could not be rendered
+                size_t skip = utf8_strlen(chunkPos) - left + 1;
+
+                for (size_t j = 0; j < skip; j++) {
+                    chunkPos += utf8_surrogate_len(chunkPos);
+                }
+
+                missing++;
+            }
+
+            if (lastGlyphCount != fontTexture->glyphs->size || lastEvictions != atlas->evictions) {
+                glyphsChanged = true;
+            }
+
+            font->unlockGlyphs();
+        }
+
+        //persist the rendered glyphs
+        if (glyphsChanged) {
+            font->saveCache();
+        }
+    }
+
+    /**
+     * Done (main thread).
+     */
+    void HandleOKCallback() {
+        //keep callback until the textures were uploaded
+        glyph_load_t *load = new glyph_load_t();
+
+        load->callback = callback;
+        load->obj.Reset(Nan::To<v8::Object>(GetFromPersistent("object")).ToLocalChecked());
+        load->missing = missing;
+
+        callback = NULL;
+
+        //upload all pages (creates textures of sizes not drawn yet)
+        AminoGfx::uploadAtlasTextures(fontSize->fontTexture->atlas, AsyncGlyphWorker::handleUploaded, load);
+    }
+
+private:
+    typedef struct {
+        Nan::Callback *callback;
+        Nan::Persistent<v8::Object> obj;
+        size_t missing;
+    } glyph_load_t;
+
+    /**
+     * Atlas textures are ready (main thread).
+     */
+    static void handleUploaded(void *data) {
+        glyph_load_t *load = (glyph_load_t *)data;
+
+        //call callback
+        v8::Local<v8::Value> argv[] = { Nan::Null(), Nan::New(load->obj), Nan::New((uint32_t)load->missing) };
+
+        Nan::Call(*load->callback, 3, argv);
+
+        //free
+        load->obj.Reset();
+        delete load->callback;
+        delete load;
+    }
+};
+
+/**
+ * Render the glyphs of a charset asynchronously.
+ */
+NAN_METHOD(AminoFontSize::LoadGlyphs) {
+    assert(info.Length() == 2);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    Nan::Utf8String str(info[0]);
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    v8::Local<v8::Object> jsObj = info.This();
+
+    assert(obj);
+
+    AsyncQueueWorker(new AsyncGlyphWorker(callback, jsObj, obj, *str));
+}
+
 //
 // AminoFontShader
 //
@@ -484,16 +1043,14 @@ void AminoFontShader::setColor(GLfloat color[3]) {
  *
  * Note: has to be called on OpenGL thread.
  */
-amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
+amino_atlas_t* AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
     std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
 
     newTexture = false;
 
     if (it == atlasTextures.end()) {
         if (!createIfMissing) {
-            amino_atlas_t item = { INVALID_TEXTURE };
-
-            return item;
+            return NULL;
         }
 
         //create new one
@@ -519,17 +1076,81 @@ amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool crea
         //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-        amino_atlas_t item;
+        amino_atlas_t &item = atlasTextures[atlas];
 
         item.textureId = id;
-
-        atlasTextures[atlas] = item;
+        item.version = 0;
 
         //debug
         //printf("create new atlas texture: %i (total: %i)\n", id, (int)atlasTextures.size());
 
-        return item;
+        return &item;
     }
 
-    return it->second;
+    return &it->second;
+}
+
+//
+// AminoSdfFontShader
+//
+
+AminoSdfFontShader::AminoSdfFontShader() : AminoFontShader() {
+    //shader
+
+    //Note: distance is 0.5 at the glyph edge (values above are inside)
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform float opacity;
+        uniform vec3 color;
+        uniform sampler2D tex;
+        uniform float smoothing;
+        uniform float outline;
+        uniform vec3 outlineColor;
+
+        varying vec2 uv;
+
+        void main() {
+            float d = texture2D(tex, uv).a;
+            float a = smoothstep(0.5 - smoothing, 0.5 + smoothing, d);
+
+            if (outline > 0.0) {
+                float edge = 0.5 - outline;
+                float o = smoothstep(edge - smoothing, edge + smoothing, d);
+
+                gl_FragColor = vec4(mix(outlineColor, color, a), opacity * o);
+            } else {
+                gl_FragColor = vec4(color, opacity * a);
+            }
+        }
+    )";
+}
+
+/**
+ * Initialize the distance field font shader.
+ */
+void AminoSdfFontShader::initShader() {
+    AminoFontShader::initShader();
+
+    //uniforms
+    uSmoothing = getUniformLocation("smoothing");
+    uOutline = getUniformLocation("outline");
+    uOutlineColor = getUniformLocation("outlineColor");
+}
+
+/**
+ * Set the anti-aliasing range (distance units).
+ */
+void AminoSdfFontShader::setSmoothing(GLfloat smoothing) {
+    glUniform1f(uSmoothing, smoothing);
+}
+
+/**
+ * Set the outline (width in distance units, 0 to disable).
+ */
+void AminoSdfFontShader::setOutline(GLfloat width, GLfloat color[3]) {
+    glUniform1f(uOutline, width);
+    glUniform3f(uOutlineColor, color[0], color[1], color[2]);
 }
@@ -5,11 +5,18 @@
 #include "vertex-buffer.h"
 
 #include <map>
+#include <vector>
+#include <atomic>
+#include <uv.h>
 
 #include "base_js.h"
 #include "gfx.h"
 #include "shaders.h"
 
+//distance field fonts (glyphs rendered once at the reference size)
+#define SDF_FONT_SIZE 48
+#define SDF_SPREAD 6
+
 class AminoFontsFactory;
 
 /**
@@ -41,6 +48,41 @@ public:
     AminoJSObject* create() override;
 };
 
+struct font_cache_size_t;
+
+/**
+ * Glyph cache file (memory mapped atlas pages, glyph metrics and kerning of all font sizes).
+ */
+class AminoFontCache {
+public:
+    AminoFontCache(std::string dir, const char *fontData, size_t fontDataLen, texture_atlas_t *atlas, rendermode_t renderMode);
+    ~AminoFontCache();
+
+    bool restoreAtlas(texture_atlas_t *atlas);
+    void restoreGlyphs(texture_font_t *fontSize, uint32_t size);
+    bool save(texture_atlas_t *atlas, std::map<uint32_t, texture_font_t *> &fontSizes);
+
+private:
+    std::string path;
+    uint64_t fontHash;
+    rendermode_t renderMode;
+
+    //memory mapped file
+    char *mapped = NULL;
+    size_t mappedLen = 0;
+
+    //restored data
+    std::map<uint32_t, const font_cache_size_t *> sizes;
+    std::vector<size_t> pageGenerations;
+    size_t glyphCount = 0;
+    uint64_t savedState = 0; //atlas state of the file
+
+    uint64_t getAtlasState(texture_atlas_t *atlas);
+    bool validate(texture_atlas_t *atlas);
+    bool inRange(uint64_t offset, uint64_t len);
+    void unmap();
+};
+
 class AminoFontFactory;
 
 /**
@@ -51,12 +93,24 @@ public:
     std::string fontName;
     int fontWeight;
     std::string fontStyle;
+    bool sdf = false;
 
     AminoFont();
     ~AminoFont();
 
     texture_font_t *getFontWithSize(uint32_t size);
     std::string getFontInfo();
+    bool saveCache();
+
+    //glyph lock (font sizes share the atlas)
+    void lockGlyphs();
+    void unlockGlyphs();
+
+    static AminoFont* fromAtlas(texture_atlas_t *atlas);
+    static uint32_t getLockContention();
+
+    static void setMaxTextureSize(int size);
+    static void checkLayoutPerformance(const char *filename);
 
     //creation
     static AminoFontFactory* getFactory();
@@ -68,14 +122,25 @@ private:
     //Note: instance kept
     static FT_Library library;
 
+    //atlas page size limit
+    static int maxAtlasSize;
+
+    //glyph lock
+    uv_mutex_t glyphMutex;
+    static std::atomic<uint32_t> lockContention;
+
     //JS constructor
     static NAN_METHOD(New);
 
+    //JS methods
+    static NAN_METHOD(SaveCache);
+
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override;
 
 protected:
     AminoFonts *fonts = NULL;
     texture_atlas_t *atlas = NULL;
+    AminoFontCache *cache = NULL;
     Nan::Persistent<v8::Object> fontData;
     std::map<uint32_t, texture_font_t *> fontSizes;
 
@@ -102,6 +167,7 @@ class AminoFontSize : public AminoJSObject {
 public:
     texture_font_t *fontTexture = NULL;
     AminoFont *font = NULL;
+    float scale = 1; //glyph scale (distance field fonts)
 
     AminoFontSize();
     ~AminoFontSize();
@@ -120,9 +186,13 @@ private:
 
     //JS methods
     static NAN_METHOD(CalcTextWidth);
+    static NAN_METHOD(CalcTextWidths);
     static NAN_METHOD(GetFontMetrics);
+    static NAN_METHOD(LoadGlyphs);
 
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override;
+
+    float measureText(const char *text, size_t len, float *advances);
 };
 
 /**
@@ -140,6 +210,7 @@ public:
  */
 struct amino_atlas_t {
     GLuint textureId;
+    size_t version; //uploaded atlas version (0: empty texture)
 };
 
 /**
@@ -151,7 +222,7 @@ public:
 
     void setColor(GLfloat color[3]);
 
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    amino_atlas_t* getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
 
 protected:
     GLint uColor;
@@ -162,4 +233,20 @@ protected:
     void initShader() override;
 };
 
+/**
+ * Distance field font shader (any size and outline).
+ */
+class AminoSdfFontShader : public AminoFontShader {
+public:
+    AminoSdfFontShader();
+
+    void setSmoothing(GLfloat smoothing);
+    void setOutline(GLfloat width, GLfloat color[3]);
+
+protected:
+    GLint uSmoothing, uOutline, uOutlineColor;
+
+    void initShader() override;
+};
+
 #endif
\ No newline at end of file
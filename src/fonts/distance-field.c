@@ -38,16 +38,16 @@
 #include "edtaa3func.h"
 
 
-double *
-make_distance_mapd( double *data, unsigned int width, unsigned int height )
+// Bipolar distance field (positive outside, negative inside); inverts data
+static void
+make_bipolar_map( double *data, unsigned int width, unsigned int height,
+                  double *dist )
 {
     short * xdist = (short *)  malloc( width * height * sizeof(short) );
     short * ydist = (short *)  malloc( width * height * sizeof(short) );
     double * gx   = (double *) calloc( width * height, sizeof(double) );
     double * gy      = (double *) calloc( width * height, sizeof(double) );
-    double * outside = (double *) calloc( width * height, sizeof(double) );
     double * inside  = (double *) calloc( width * height, sizeof(double) );
-    double vmin = DBL_MAX;
     unsigned int i;
 
     //@appamics.CB: extra checks
@@ -55,15 +55,14 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
     assert(ydist);
     assert(gx);
     assert(gy);
-    assert(outside);
     assert(inside);
 
     // Compute outside = edtaa3(bitmap); % Transform background (0's)
     computegradient( data, width, height, gx, gy);
-    edtaa3(data, gx, gy, width, height, xdist, ydist, outside);
+    edtaa3(data, gx, gy, width, height, xdist, ydist, dist);
     for( i=0; i<width*height; ++i)
-        if( outside[i] < 0.0 )
-            outside[i] = 0.0;
+        if( dist[i] < 0.0 )
+            dist[i] = 0.0;
 
     // Compute inside = edtaa3(1-bitmap); % Transform foreground (1's)
     memset( gx, 0, sizeof(double)*width*height );
@@ -77,9 +76,30 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
             inside[i] = 0.0;
 
     // distmap = outside - inside; % Bipolar distance field
+    for( i=0; i<width*height; ++i)
+        dist[i] -= inside[i];
+
+    free( xdist );
+    free( ydist );
+    free( gx );
+    free( gy );
+    free( inside );
+}
+
+double *
+make_distance_mapd( double *data, unsigned int width, unsigned int height )
+{
+    double * outside = (double *) calloc( width * height, sizeof(double) );
+    double vmin = DBL_MAX;
+    unsigned int i;
+
+    //@appamics.CB: extra checks
+    assert(outside);
+
+    make_bipolar_map( data, width, height, outside );
+
     for( i=0; i<width*height; ++i)
     {
-        outside[i] -= inside[i];
         if( outside[i] < vmin )
             vmin = outside[i];
     }
@@ -94,12 +114,7 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
         data[i] = (outside[i]+vmin)/(2*vmin);
     }
 
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
     free( outside );
-    free( inside );
     return data;
 }
 
@@ -143,3 +158,39 @@ make_distance_mapb( unsigned char *img,
 
     return out;
 }
+
+unsigned char *
+make_signed_distance_mapb( const unsigned char *img,
+                           unsigned int width, unsigned int height,
+                           double spread )
+{
+    double * data = (double *) malloc( width * height * sizeof(double) );
+    double * dist = (double *) calloc( width * height, sizeof(double) );
+    unsigned char *out = (unsigned char *) malloc( width * height * sizeof(unsigned char) );
+    unsigned int i;
+
+    assert(data);
+    assert(dist);
+    assert(out);
+    assert(spread > 0);
+
+    for( i=0; i<width*height; ++i)
+        data[i] = img[i] / 255.0;
+
+    make_bipolar_map( data, width, height, dist );
+
+    // 0.5 at the edge, 1.0 at spread pixels inside, 0.0 at spread pixels outside
+    for( i=0; i<width*height; ++i)
+    {
+        double v = 0.5 - dist[i] / (2 * spread);
+
+        if     ( v < 0.0 ) v = 0.0;
+        else if( v > 1.0 ) v = 1.0;
+        out[i] = (unsigned char)(255 * v + 0.5);
+    }
+
+    free( data );
+    free( dist );
+
+    return out;
+}
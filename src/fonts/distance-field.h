@@ -85,6 +85,23 @@ unsigned char *
 make_distance_mapb( unsigned char *img,
                     unsigned int width, unsigned int height );
 
+/**
+ * Create a signed distance field with a fixed spread (same scale for all
+ * glyphs).
+ *
+ * @param img     A greyscale image (0: outside, 255: inside).
+ * @param width   The width of the given image.
+ * @param height  The height of the given image.
+ * @param spread  Distance (in pixels) mapped to the full value range.
+ *
+ * @return        A newly allocated distance field (128 at the edge). This
+ *                image must be freed after usage.
+ */
+unsigned char *
+make_signed_distance_mapb( const unsigned char *img,
+                           unsigned int width, unsigned int height,
+                           double spread );
+
 /** @} */
 
 #ifdef __cplusplus
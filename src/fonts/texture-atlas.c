@@ -65,6 +65,21 @@ texture_atlas_new( const size_t width,
     self->depth = depth;
     self->id = 0;
 
+    self->page = 0;
+    self->next = NULL;
+    self->max_size = width;
+    self->max_pages = 1;
+    self->clock = 0;
+    self->last_used = 0;
+    self->locked = 0;
+    self->generation = 0;
+    self->evictions = 0;
+    self->version = 1;
+    self->special_page = NULL;
+    self->special_generation = 0;
+    self->user_data = NULL;
+    self->external_data = 0;
+
     vector_push_back( self->nodes, &node );
     self->data = (unsigned char *)
         calloc( width*height*depth, sizeof(unsigned char) );
@@ -85,8 +100,12 @@ void
 texture_atlas_delete( texture_atlas_t *self )
 {
     assert( self );
+    if( self->next )
+    {
+        texture_atlas_delete( self->next );
+    }
     vector_delete( self->nodes );
-    if( self->data )
+    if( self->data && !self->external_data )
     {
         free( self->data );
     }
@@ -94,6 +113,26 @@ texture_atlas_delete( texture_atlas_t *self )
 }
 
 
+// ----------------------------------------------- texture_atlas_mark_dirty ---
+static void
+texture_atlas_mark_dirty( texture_atlas_t * self,
+                          const size_t x,
+                          const size_t y,
+                          const size_t width,
+                          const size_t height )
+{
+    ivec4 *region;
+
+    self->version++;
+
+    region = &self->dirty[self->version % TEXTURE_ATLAS_DIRTY_LOG];
+    region->x = x;
+    region->y = y;
+    region->width = width;
+    region->height = height;
+}
+
+
 // ----------------------------------------------- texture_atlas_set_region ---
 void
 texture_atlas_set_region( texture_atlas_t * self,
@@ -123,6 +162,8 @@ texture_atlas_set_region( texture_atlas_t * self,
         memcpy( self->data+((y+i)*self->width + x ) * charsize * depth,
                 data + (i*stride) * charsize, width * charsize * depth  );
     }
+
+    texture_atlas_mark_dirty( self, x, y, width, height );
 }
 
 
@@ -296,4 +337,184 @@ texture_atlas_clear( texture_atlas_t * self )
 
     vector_push_back( self->nodes, &node );
     memset( self->data, 0, self->width*self->height*self->depth );
+    self->generation++;
+
+    texture_atlas_mark_dirty( self, 0, 0, self->width, self->height );
+}
+
+
+// ------------------------------------------------- texture_atlas_set_data ---
+void
+texture_atlas_set_data( texture_atlas_t * self,
+                        unsigned char * data,
+                        const size_t used,
+                        const ivec3 * nodes,
+                        const size_t count )
+{
+    size_t i;
+
+    assert( self );
+    assert( data );
+    assert( count > 0 );
+
+    if( self->data && !self->external_data )
+    {
+        free( self->data );
+    }
+    self->data = data;
+    self->external_data = 1;
+
+    vector_clear( self->nodes );
+    for( i = 0; i < count; ++i )
+    {
+        vector_push_back( self->nodes, &nodes[i] );
+    }
+    self->used = used;
+
+    texture_atlas_mark_dirty( self, 0, 0, self->width, self->height );
+}
+
+
+// ------------------------------------------------- texture_atlas_add_page ---
+texture_atlas_t *
+texture_atlas_add_page( texture_atlas_t * self )
+{
+    texture_atlas_t *last, *page;
+    size_t size;
+
+    assert( self );
+
+    last = self;
+    while( last->next )
+    {
+        last = last->next;
+    }
+
+    if( (size_t)(last->page + 1) >= self->max_pages )
+    {
+        return NULL;
+    }
+
+    size = last->width * 2;
+    if( size > self->max_size )
+    {
+        size = self->max_size;
+    }
+    if( size < last->width )
+    {
+        size = last->width;
+    }
+
+    page = texture_atlas_new( size, size, self->depth );
+    page->page = last->page + 1;
+    page->max_size = self->max_size;
+    page->max_pages = self->max_pages;
+    page->user_data = self->user_data;
+    last->next = page;
+
+    return page;
+}
+
+
+// ----------------------------------------------- texture_atlas_evict_page ---
+texture_atlas_t *
+texture_atlas_evict_page( texture_atlas_t * self )
+{
+    texture_atlas_t *page, *lru = NULL;
+
+    assert( self );
+
+    for( page = self; page; page = page->next )
+    {
+        if( page->last_used >= self->locked )
+        {
+            continue;
+        }
+        if( !lru || page->last_used < lru->last_used )
+        {
+            lru = page;
+        }
+    }
+
+    if( lru )
+    {
+        texture_atlas_clear( lru );
+        self->evictions++;
+    }
+
+    return lru;
+}
+
+
+// ---------------------------------------------------- texture_atlas_touch ---
+void
+texture_atlas_touch( texture_atlas_t * self,
+                     texture_atlas_t * page )
+{
+    assert( self );
+    assert( page );
+
+    page->last_used = ++self->clock;
+}
+
+
+// ------------------------------------------------ texture_atlas_lock_used ---
+void
+texture_atlas_lock_used( texture_atlas_t * self )
+{
+    assert( self );
+
+    self->locked = self->clock + 1;
+}
+
+
+// ------------------------------------------------ texture_atlas_get_dirty ---
+int
+texture_atlas_get_dirty( const texture_atlas_t * self,
+                         const size_t version,
+                         ivec4 * region )
+{
+    size_t v;
+    int x0, y0, x1, y1;
+
+    assert( self );
+    assert( region );
+
+    if( version >= self->version )
+    {
+        return 0;
+    }
+
+    if( self->version - version > TEXTURE_ATLAS_DIRTY_LOG )
+    {
+        region->x = 0;
+        region->y = 0;
+        region->width = self->width;
+        region->height = self->height;
+
+        return 1;
+    }
+
+    // union of all regions modified after version
+    x0 = self->width;
+    y0 = self->height;
+    x1 = 0;
+    y1 = 0;
+
+    for( v = version + 1; v <= self->version; ++v )
+    {
+        const ivec4 *dirty = &self->dirty[v % TEXTURE_ATLAS_DIRTY_LOG];
+
+        if( dirty->x < x0 ) x0 = dirty->x;
+        if( dirty->y < y0 ) y0 = dirty->y;
+        if( dirty->x + dirty->width > x1 ) x1 = dirty->x + dirty->width;
+        if( dirty->y + dirty->height > y1 ) y1 = dirty->y + dirty->height;
+    }
+
+    region->x = x0;
+    region->y = y0;
+    region->width = x1 - x0;
+    region->height = y1 - y0;
+
+    return 1;
 }
@@ -57,6 +57,11 @@ extern "C" {
 namespace ftgl {
 #endif
 
+/**
+ * Number of modified regions kept to update textures incrementally.
+ */
+#define TEXTURE_ATLAS_DIRTY_LOG 32
+
 /**
  * @file   texture-atlas.h
  * @author Nicolas Rougier (Nicolas.Rougier@inria.fr)
@@ -136,6 +141,70 @@ typedef struct texture_atlas_t
      */
     unsigned char * data;
 
+    /**
+     * Page index (0: first page)
+     */
+    int page;
+
+    /**
+     * Next page (NULL if this is the last page)
+     */
+    struct texture_atlas_t * next;
+
+    /**
+     * Maximum page size and page count (first page)
+     */
+    size_t max_size;
+    size_t max_pages;
+
+    /**
+     * LRU clock (first page) and last use of this page
+     */
+    size_t clock;
+    size_t last_used;
+
+    /**
+     * Pages used since this clock value are not evicted (first page)
+     */
+    size_t locked;
+
+    /**
+     * Incremented each time the page is cleared
+     */
+    size_t generation;
+
+    /**
+     * Number of evicted pages (first page)
+     */
+    size_t evictions;
+
+    /**
+     * Incremented each time the data is modified (starts at 1)
+     */
+    size_t version;
+
+    /**
+     * Modified regions of the last versions (x, y, width, height)
+     */
+    ivec4 dirty[TEXTURE_ATLAS_DIRTY_LOG];
+
+    /**
+     * Region of the special glyph shared by all font sizes (first page, NULL if none)
+     */
+    struct texture_atlas_t * special_page;
+    size_t special_generation;
+    ivec4 special_region;
+
+    /**
+     * Owner data (shared by all pages)
+     */
+    void * user_data;
+
+    /**
+     * Data is not owned by the atlas (e.g. memory mapped file)
+     */
+    int external_data;
+
 } texture_atlas_t;
 
 
@@ -209,6 +278,76 @@ typedef struct texture_atlas_t
   void
   texture_atlas_clear( texture_atlas_t * self );
 
+/**
+ *  Use external data (e.g. a memory mapped cache file) and restore the
+ *  allocated nodes. The data has to stay valid until the page is deleted.
+ *
+ *  @param self   a texture atlas page
+ *  @param data   page data (width * height * depth bytes)
+ *  @param used   allocated surface size
+ *  @param nodes  skyline nodes
+ *  @param count  number of nodes
+ */
+  void
+  texture_atlas_set_data( texture_atlas_t * self,
+                          unsigned char * data,
+                          const size_t used,
+                          const ivec3 * nodes,
+                          const size_t count );
+
+/**
+ *  Add a page to the atlas. The page is twice the size of the last page
+ *  (limited by max_size).
+ *
+ *  @param self   the first page of a texture atlas
+ *  @return       the new page or NULL if max_pages is reached
+ */
+  texture_atlas_t *
+  texture_atlas_add_page( texture_atlas_t * self );
+
+/**
+ *  Clear the least recently used page which was not used since the last
+ *  call of texture_atlas_lock_used().
+ *
+ *  @param self   the first page of a texture atlas
+ *  @return       the cleared page or NULL if all pages are in use
+ */
+  texture_atlas_t *
+  texture_atlas_evict_page( texture_atlas_t * self );
+
+/**
+ *  Mark a page as recently used.
+ *
+ *  @param self   the first page of a texture atlas
+ *  @param page   a page of the atlas
+ */
+  void
+  texture_atlas_touch( texture_atlas_t * self,
+                       texture_atlas_t * page );
+
+/**
+ *  Protect the pages touched from now on from being evicted (e.g. while
+ *  laying out a text).
+ *
+ *  @param self   the first page of a texture atlas
+ */
+  void
+  texture_atlas_lock_used( texture_atlas_t * self );
+
+/**
+ *  Get the region modified since a given version.
+ *
+ *  @param self      a texture atlas page
+ *  @param version   version of the data known by the caller (e.g. a texture)
+ *  @param region    union of the modified regions (the whole page if the
+ *                   version is too old)
+ *  @return          0 if nothing was modified, 1 otherwise
+ */
+  int
+  texture_atlas_get_dirty( const texture_atlas_t * self,
+                           const size_t version,
+                           ivec4 * region );
+
 
 /** @} */
 
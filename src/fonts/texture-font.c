@@ -38,6 +38,7 @@
 #include FT_LCD_FILTER_H
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
@@ -50,6 +51,10 @@
 #define HRESf 64.f
 #define DPI   72
 
+/* Open addressing tables (power of two sizes, max. load factor 0.5) */
+#define GLYPH_MAP_INITIAL_SIZE   64
+#define KERNING_MAP_INITIAL_SIZE 256
+
 #undef __FTERRORS_H__
 #define FT_ERRORDEF( e, v, s )  { e, s },
 #define FT_ERROR_START_LIST     {
@@ -207,7 +212,9 @@ texture_glyph_new(void)
     self->t0        = 0.0;
     self->s1        = 0.0;
     self->t1        = 0.0;
-    self->kerning   = vector_new( sizeof(kerning_t) );
+    self->glyph_index = 0;
+    self->atlas     = NULL;
+    self->generation = 0;
     return self;
 }
 
@@ -217,66 +224,268 @@ void
 texture_glyph_delete( texture_glyph_t *self )
 {
     assert( self );
-    vector_delete( self->kerning );
     free( self );
 }
 
-// ---------------------------------------------- texture_glyph_get_kerning ---
-float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint )
+// ------------------------------------------------- texture_glyph_is_valid ---
+int
+texture_glyph_is_valid( const texture_glyph_t * self )
+{
+    assert( self );
+
+    return self->atlas && self->generation == self->atlas->generation;
+}
+
+// --------------------------------------------------------- hash_codepoint ---
+static size_t
+hash_codepoint( uint32_t codepoint )
+{
+    /* Knuth multiplicative hash */
+    return (size_t)(codepoint * 2654435761u);
+}
+
+// ------------------------------------------------------ hash_kerning_pair ---
+static size_t
+hash_kerning_pair( uint64_t key )
+{
+    key *= 0x9E3779B97F4A7C15ull;
+
+    return (size_t)(key ^ (key >> 32));
+}
+
+// ----------------------------------------------- texture_font_index_glyph ---
+static void
+texture_font_index_glyph( texture_font_t *self, texture_glyph_t *glyph )
+{
+    size_t mask = self->glyph_map_size - 1;
+    size_t i = hash_codepoint( glyph->codepoint ) & mask;
+
+    /* Note: glyphs with different render modes share the codepoint */
+    while( self->glyph_map[i] )
+    {
+        i = (i + 1) & mask;
+    }
+
+    self->glyph_map[i] = glyph;
+}
+
+// ------------------------------------------------- texture_font_add_glyph ---
+static int
+texture_font_add_glyph( texture_font_t *self, texture_glyph_t *glyph )
 {
     size_t i;
-    uint32_t ucodepoint = utf8_to_utf32( codepoint );
+
+    vector_push_back( self->glyphs, &glyph );
+
+    /* Grow index */
+    if( self->glyphs->size * 2 > self->glyph_map_size )
+    {
+        size_t size = self->glyph_map_size * 2;
+        texture_glyph_t **map = (texture_glyph_t **) calloc( size, sizeof(texture_glyph_t *) );
+
+        if( map == NULL )
+        {
+            fprintf( stderr,
+                    "line %d: No more memory for allocating data\n", __LINE__ );
+            return 0;
+        }
+
+        free( self->glyph_map );
+        self->glyph_map = map;
+        self->glyph_map_size = size;
+
+        for( i = 0; i < self->glyphs->size; ++i )
+        {
+            texture_font_index_glyph( self, *(texture_glyph_t **) vector_get( self->glyphs, i ) );
+        }
+
+        return 1;
+    }
+
+    texture_font_index_glyph( self, glyph );
+
+    return 1;
+}
+
+// ---------------------------------------------- texture_font_insert_glyph ---
+int
+texture_font_insert_glyph( texture_font_t *self, texture_glyph_t *glyph )
+{
+    assert( self );
+    assert( glyph );
+    assert( glyph->atlas );
+
+    return texture_font_add_glyph( self, glyph );
+}
+
+// ----------------------------------------------- texture_font_set_kerning ---
+void
+texture_font_set_kerning( texture_font_t *self, uint32_t left, uint32_t right, float kerning )
+{
+    size_t i, mask;
+    uint64_t key = ((uint64_t)left << 32) | right;
+
+    /* Grow table */
+    if( (self->kerning_map_count + 1) * 2 > self->kerning_map_size )
+    {
+        size_t size = self->kerning_map_size * 2;
+        kerning_pair_t *map = (kerning_pair_t *) malloc( size * sizeof(kerning_pair_t) );
+        kerning_pair_t *old_map = self->kerning_map;
+        size_t old_size = self->kerning_map_size;
+
+        if( map == NULL )
+        {
+            fprintf( stderr,
+                    "line %d: No more memory for allocating data\n", __LINE__ );
+            return;
+        }
+
+        for( i = 0; i < size; ++i )
+        {
+            map[i].key = KERNING_MAP_EMPTY;
+        }
+
+        self->kerning_map = map;
+        self->kerning_map_size = size;
+        mask = size - 1;
+
+        for( i = 0; i < old_size; ++i )
+        {
+            size_t j;
+
+            if( old_map[i].key == KERNING_MAP_EMPTY )
+            {
+                continue;
+            }
+
+            j = hash_kerning_pair( old_map[i].key ) & mask;
+
+            while( map[j].key != KERNING_MAP_EMPTY )
+            {
+                j = (j + 1) & mask;
+            }
+
+            map[j] = old_map[i];
+        }
+
+        free( old_map );
+    }
+
+    /* Insert or update */
+    mask = self->kerning_map_size - 1;
+    i = hash_kerning_pair( key ) & mask;
+
+    while( self->kerning_map[i].key != KERNING_MAP_EMPTY )
+    {
+        if( self->kerning_map[i].key == key )
+        {
+            self->kerning_map[i].kerning = kerning;
+            return;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    self->kerning_map[i].key = key;
+    self->kerning_map[i].kerning = kerning;
+    self->kerning_map_count++;
+}
+
+// ----------------------------------------------- texture_font_get_kerning ---
+float
+texture_font_get_kerning( const texture_font_t * self,
+                          uint32_t left,
+                          uint32_t right )
+{
+    size_t i, mask;
+    uint64_t key = ((uint64_t)left << 32) | right;
 
     assert( self );
-    for( i=0; i<vector_size(self->kerning); ++i )
+
+    /* Most fonts have no kerning pairs for the loaded glyphs */
+    if( !self->kerning_map_count )
+    {
+        return 0;
+    }
+
+    mask = self->kerning_map_size - 1;
+    i = hash_kerning_pair( key ) & mask;
+
+    while( self->kerning_map[i].key != KERNING_MAP_EMPTY )
     {
-        kerning_t * kerning = (kerning_t *) vector_get( self->kerning, i );
-        if( kerning->codepoint == ucodepoint )
+        if( self->kerning_map[i].key == key )
         {
-            return kerning->kerning;
+            return self->kerning_map[i].kerning;
         }
+
+        i = (i + 1) & mask;
     }
+
     return 0;
 }
 
+// ----------------------------------------------- texture_font_add_kerning ---
+static void
+texture_font_add_kerning( texture_font_t *self, size_t index )
+{
+    size_t j;
+    texture_glyph_t *glyph, *prev_glyph;
+    FT_Vector kerning;
+
+    glyph = *(texture_glyph_t **) vector_get( self->glyphs, index );
+
+    /* Check all pairs with the previously loaded glyphs (both directions) */
+    /* Starts at index 1 since 0 is for the special background glyph */
+    for( j=1; j<=index; ++j )
+    {
+        prev_glyph = *(texture_glyph_t **) vector_get( self->glyphs, j );
+
+        FT_Get_Kerning( self->face, prev_glyph->glyph_index, glyph->glyph_index, FT_KERNING_UNFITTED, &kerning );
+        if( kerning.x )
+        {
+            texture_font_set_kerning( self, prev_glyph->codepoint, glyph->codepoint, kerning.x / (float)(HRESf*HRESf) );
+        }
+
+        if( j == index )
+        {
+            break;
+        }
+
+        FT_Get_Kerning( self->face, glyph->glyph_index, prev_glyph->glyph_index, FT_KERNING_UNFITTED, &kerning );
+        if( kerning.x )
+        {
+            texture_font_set_kerning( self, glyph->codepoint, prev_glyph->codepoint, kerning.x / (float)(HRESf*HRESf) );
+        }
+    }
+}
 
 // ------------------------------------------ texture_font_generate_kerning ---
 void
 texture_font_generate_kerning( texture_font_t *self)
 {
-    size_t i, j;
-    FT_UInt glyph_index, prev_index;
-    texture_glyph_t *glyph, *prev_glyph;
-    FT_Vector kerning;
+    size_t i;
 
     assert( self );
     assert(self->library);
     assert(self->face);
 
+    /* Reset table */
+    for( i=0; i<self->kerning_map_size; ++i )
+    {
+        self->kerning_map[i].key = KERNING_MAP_EMPTY;
+    }
+
+    self->kerning_map_count = 0;
+
+    if( !FT_HAS_KERNING( self->face ) )
+    {
+        return;
+    }
+
     /* For each glyph couple combination, check if kerning is necessary */
-    /* Starts at index 1 since 0 is for the special background glyph */
     for( i=1; i<self->glyphs->size; ++i )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        glyph_index = FT_Get_Char_Index( self->face, glyph->codepoint );
-        vector_clear( glyph->kerning );
-
-        for( j=1; j<self->glyphs->size; ++j )
-        {
-            prev_glyph = *(texture_glyph_t **) vector_get( self->glyphs, j );
-            prev_index = FT_Get_Char_Index( self->face, prev_glyph->codepoint );
-            FT_Get_Kerning( self->face, prev_index, glyph_index, FT_KERNING_UNFITTED, &kerning );
-            // printf("%c(%d)-%c(%d): %ld\n",
-            //       prev_glyph->codepoint, prev_glyph->codepoint,
-            //       glyph_index, glyph_index, kerning.x);
-            if( kerning.x )
-            {
-                kerning_t k = {prev_glyph->codepoint, kerning.x / (float)(HRESf*HRESf)};
-                vector_push_back( glyph->kerning, &k );
-            }
-        }
+        texture_font_add_kerning( self, i );
     }
 }
 
@@ -293,11 +502,29 @@ texture_font_init(texture_font_t *self, FT_Library library)
             && self->memory.base && self->memory.size));
 
     self->glyphs = vector_new(sizeof(texture_glyph_t *));
+
+    self->glyph_map_size = GLYPH_MAP_INITIAL_SIZE;
+    self->glyph_map = (texture_glyph_t **) calloc(self->glyph_map_size, sizeof(texture_glyph_t *));
+
+    self->kerning_map_size = KERNING_MAP_INITIAL_SIZE;
+    self->kerning_map_count = 0;
+    self->kerning_map = (kerning_pair_t *) malloc(self->kerning_map_size * sizeof(kerning_pair_t));
+
+    if (!self->glyph_map || !self->kerning_map) {
+        fprintf(stderr,
+                "line %d: No more memory for allocating data\n", __LINE__);
+        return -1;
+    }
+
+    for (size_t i = 0; i < self->kerning_map_size; i++) {
+        self->kerning_map[i].key = KERNING_MAP_EMPTY;
+    }
     self->height = 0;
     self->ascender = 0;
     self->descender = 0;
     self->rendermode = RENDER_NORMAL;
     self->outline_thickness = 0.0;
+    self->distance_spread = 4.0;
     self->hinting = 1;
     self->kerning = 1;
     self->filtering = 1;
@@ -445,20 +672,25 @@ texture_font_delete( texture_font_t *self )
     }
 
     vector_delete( self->glyphs );
+    free( self->glyph_map );
+    free( self->kerning_map );
     free( self );
 }
 
+// ------------------------------------------------ texture_font_find_glyph ---
 texture_glyph_t *
 texture_font_find_glyph( texture_font_t * self,
                          const char * codepoint )
 {
-    size_t i;
+    size_t i, mask;
     texture_glyph_t *glyph;
     uint32_t ucodepoint = utf8_to_utf32( codepoint );
 
-    for( i = 0; i < self->glyphs->size; ++i )
+    mask = self->glyph_map_size - 1;
+    i = hash_codepoint( ucodepoint ) & mask;
+
+    while( (glyph = self->glyph_map[i]) )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
         // If codepoint is -1, we don't care about outline type or thickness
         if( (glyph->codepoint == ucodepoint) &&
             ((ucodepoint == UINT32_MAX) ||
@@ -467,6 +699,48 @@ texture_font_find_glyph( texture_font_t * self,
         {
             return glyph;
         }
+
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+// ------------------------------------------------ texture_font_get_region ---
+static texture_atlas_t *
+texture_font_get_region( texture_font_t * self,
+                         const size_t width,
+                         const size_t height,
+                         ivec4 * region )
+{
+    texture_atlas_t *page;
+
+    /* Find space in the existing pages */
+    for( page = self->atlas; page; page = page->next )
+    {
+        *region = texture_atlas_get_region( page, width, height );
+        if( region->x >= 0 )
+        {
+            texture_atlas_touch( self->atlas, page );
+            return page;
+        }
+    }
+
+    /* Add a page or reuse the least recently used one */
+    page = texture_atlas_add_page( self->atlas );
+    if( !page )
+    {
+        page = texture_atlas_evict_page( self->atlas );
+    }
+
+    if( page )
+    {
+        *region = texture_atlas_get_region( page, width, height );
+        if( region->x >= 0 )
+        {
+            texture_atlas_touch( self->atlas, page );
+            return page;
+        }
     }
 
     return NULL;
@@ -485,7 +759,8 @@ texture_font_load_glyph( texture_font_t * self,
     FT_Bitmap ft_bitmap;
 
     FT_UInt glyph_index;
-    texture_glyph_t *glyph;
+    texture_glyph_t *glyph, *evicted;
+    texture_atlas_t *atlas;
     FT_Int32 flags = 0;
     int ft_glyph_top = 0;
     int ft_glyph_left = 0;
@@ -497,34 +772,57 @@ texture_font_load_glyph( texture_font_t * self,
     assert(self->face);
 
     /* Check if codepoint has been already loaded */
-    if (texture_font_find_glyph(self, codepoint)) {
+    evicted = texture_font_find_glyph(self, codepoint);
+
+    if (evicted && texture_glyph_is_valid(evicted)) {
         return 1;
     }
 
+    /* Evicted glyphs are rendered again (keeping the glyph instance) */
+
     /* codepoint NULL is special : it is used for line drawing (overline,
      * underline, strikethrough) and background.
      */
     if( !codepoint )
     {
-        ivec4 region = texture_atlas_get_region( self->atlas, 5, 5 );
-        texture_glyph_t * glyph = texture_glyph_new( );
+        ivec4 region;
+        texture_glyph_t * glyph;
         static unsigned char data[4*4*3] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
                                             -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
                                             -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
                                             -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1};
-        if ( region.x < 0 )
+        texture_atlas_t * root = self->atlas;
+
+        /* Same content for all font sizes: reuse the region (e.g. restored from a cache) */
+        if( root->special_page && root->special_page->generation == root->special_generation )
         {
-            fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
-            return 0;
+            atlas = root->special_page;
+            region = root->special_region;
+        }
+        else
+        {
+            atlas = texture_font_get_region( self, 5, 5, &region );
+            if ( !atlas )
+            {
+                fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
+                return 0;
+            }
+            texture_atlas_set_region( atlas, region.x, region.y, 4, 4, data, 0 );
+            root->special_page = atlas;
+            root->special_generation = atlas->generation;
+            root->special_region = region;
         }
-        texture_atlas_set_region( self->atlas, region.x, region.y, 4, 4, data, 0 );
+        glyph = evicted ? evicted : texture_glyph_new( );
         glyph->codepoint = -1;
-        glyph->s0 = (region.x+2)/(float)self->atlas->width;
-        glyph->t0 = (region.y+2)/(float)self->atlas->height;
-        glyph->s1 = (region.x+3)/(float)self->atlas->width;
-        glyph->t1 = (region.y+3)/(float)self->atlas->height;
-        vector_push_back( self->glyphs, &glyph );
-        return 1;
+        glyph->atlas = atlas;
+        glyph->generation = atlas->generation;
+        glyph->s0 = (region.x+2)/(float)atlas->width;
+        glyph->t0 = (region.y+2)/(float)atlas->height;
+        glyph->s1 = (region.x+3)/(float)atlas->width;
+        glyph->t1 = (region.y+3)/(float)atlas->height;
+        if( evicted )
+            return 1;
+        return texture_font_add_glyph( self, glyph );
     }
 
     flags = 0;
@@ -654,25 +952,26 @@ cleanup_stroker:
         int bottom;
     } padding = { 0, 0, 1, 1 };
 
-    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
-    {
-        padding.top = 1;
-        padding.left = 1;
-    }
-
     //@appamics.CB: fix for vertical lines from next glyph in atlas
     padding.left = 1;
     padding.top = 1;
 
+    /* Room for the distance field around the glyph */
+    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
+    {
+        padding.left = padding.top = (int)ceilf( self->distance_spread );
+        padding.right = padding.bottom = padding.left;
+    }
+
     size_t src_w = ft_bitmap.width/self->atlas->depth;
     size_t src_h = ft_bitmap.rows;
 
     size_t tgt_w = src_w + padding.left + padding.right;
     size_t tgt_h = src_h + padding.top + padding.bottom;
 
-    region = texture_atlas_get_region( self->atlas, tgt_w, tgt_h );
+    atlas = texture_font_get_region( self, tgt_w, tgt_h, &region );
 
-    if ( region.x < 0 )
+    if ( !atlas )
     {
         fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
         return 0;
@@ -693,27 +992,35 @@ cleanup_stroker:
 
     if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
     {
-        unsigned char *sdf = make_distance_mapb( buffer, tgt_w, tgt_h );
+        unsigned char *sdf = make_signed_distance_mapb( buffer, tgt_w, tgt_h, self->distance_spread );
         free( buffer );
         buffer = sdf;
     }
 
-    texture_atlas_set_region( self->atlas, x, y, tgt_w, tgt_h, buffer, tgt_w );
+    texture_atlas_set_region( atlas, x, y, tgt_w, tgt_h, buffer, tgt_w );
 
     free( buffer );
 
-    glyph = texture_glyph_new( );
+    glyph = evicted ? evicted : texture_glyph_new( );
     glyph->codepoint = utf8_to_utf32( codepoint );
+    glyph->glyph_index = glyph_index;
     glyph->width    = tgt_w;
     glyph->height   = tgt_h;
     glyph->rendermode = self->rendermode;
     glyph->outline_thickness = self->outline_thickness;
     glyph->offset_x = ft_glyph_left;
     glyph->offset_y = ft_glyph_top;
-    glyph->s0       = x/(float)self->atlas->width;
-    glyph->t0       = y/(float)self->atlas->height;
-    glyph->s1       = (x + glyph->width)/(float)self->atlas->width;
-    glyph->t1       = (y + glyph->height)/(float)self->atlas->height;
+    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
+    {
+        glyph->offset_x -= padding.left;
+        glyph->offset_y += padding.top;
+    }
+    glyph->atlas    = atlas;
+    glyph->generation = atlas->generation;
+    glyph->s0       = x/(float)atlas->width;
+    glyph->t0       = y/(float)atlas->height;
+    glyph->s1       = (x + glyph->width)/(float)atlas->width;
+    glyph->t1       = (y + glyph->height)/(float)atlas->height;
 
     // Discard hinting to get advance
     FT_Load_Glyph( self->face, glyph_index, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);
@@ -721,12 +1028,18 @@ cleanup_stroker:
     glyph->advance_x = slot->advance.x / HRESf;
     glyph->advance_y = slot->advance.y / HRESf;
 
-    vector_push_back( self->glyphs, &glyph );
-
     if( self->rendermode != RENDER_NORMAL && self->rendermode != RENDER_SIGNED_DISTANCE_FIELD )
         FT_Done_Glyph( ft_glyph );
 
-    texture_font_generate_kerning( self );
+    if( evicted )
+        return 1;
+
+    if( !texture_font_add_glyph( self, glyph ) )
+        return 0;
+
+    /* Only add the pairs of the new glyph */
+    if( FT_HAS_KERNING( self->face ) )
+        texture_font_add_kerning( self, self->glyphs->size - 1 );
 
     return 1;
 }
@@ -736,10 +1049,11 @@ size_t
 texture_font_load_glyphs( texture_font_t * self,
                           const char * codepoints )
 {
-    size_t i;
+    size_t i, len;
 
-    /* Load each glyph */
-    for( i = 0; i < utf8_strlen(codepoints); i += utf8_surrogate_len(codepoints + i) ) {
+    /* Load each glyph (i is a byte offset) */
+    len = strlen( codepoints );
+    for( i = 0; i < len; i += utf8_surrogate_len(codepoints + i) ) {
         if( !texture_font_load_glyph( self, codepoints + i ) )
             return utf8_strlen( codepoints + i );
 
@@ -761,10 +1075,13 @@ texture_font_get_glyph( texture_font_t * self,
     assert( self->atlas );
 
     /* Check if codepoint has been already loaded */
-    if( (glyph = texture_font_find_glyph( self, codepoint )) )
+    if( (glyph = texture_font_find_glyph( self, codepoint )) && texture_glyph_is_valid( glyph ) )
+    {
+        texture_atlas_touch( self->atlas, glyph->atlas );
         return glyph;
+    }
 
-    /* Glyph has not been already loaded */
+    /* Glyph has not been already loaded (or was evicted) */
     if( texture_font_load_glyph( self, codepoint ) )
         return texture_font_find_glyph( self, codepoint );
 
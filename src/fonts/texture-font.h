@@ -91,25 +91,30 @@ typedef enum rendermode_t
 
 
 /**
- * A structure that hold a kerning value relatively to a Unicode
- * codepoint.
+ * A structure that hold a kerning value of a pair of Unicode codepoints.
  *
- * This structure cannot be used alone since the (necessary) right
- * Unicode codepoint is implicitely held by the owner of this structure.
+ * Used by the kerning table of the font (replaces the per glyph kerning
+ * vectors).
  */
-typedef struct kerning_t
+/**
+ * Unused kerning map entry.
+ */
+#define KERNING_MAP_EMPTY UINT64_MAX
+
+typedef struct kerning_pair_t
 {
     /**
-     * Left Unicode codepoint in the kern pair in UTF-32 LE encoding.
+     * Left (high 32 bits) and right (low 32 bits) Unicode codepoint of the
+     * kern pair in UTF-32 LE encoding.
      */
-    uint32_t codepoint;
+    uint64_t key;
 
     /**
      * Kerning value (in fractional pixels).
      */
     float kerning;
 
-} kerning_t;
+} kerning_pair_t;
 
 
 
@@ -215,9 +220,19 @@ typedef struct texture_glyph_t
     float t1;
 
     /**
-     * A vector of kerning pairs relative to this glyph.
+     * FreeType glyph index (used to look up the kerning pairs).
+     */
+    FT_UInt glyph_index;
+
+    /**
+     * Atlas page containing the glyph bitmap.
+     */
+    texture_atlas_t * atlas;
+
+    /**
+     * Generation of the atlas page (glyph was evicted if changed).
      */
-    vector_t * kerning;
+    size_t generation;
 
     /**
      * Mode this glyph was rendered
@@ -291,6 +306,12 @@ typedef struct texture_font_t
      */
     float outline_thickness;
 
+    /**
+     * Distance (in pixels) covered by signed distance field glyphs (padding
+     * around the glyph bitmap)
+     */
+    float distance_spread;
+
     /**
      * Whether to use our own lcd filter.
      */
@@ -362,6 +383,15 @@ typedef struct texture_font_t
     int libraryShared;
     FT_Face face;
 
+    //glyph index (open addressing, codepoint -> glyph)
+    texture_glyph_t ** glyph_map;
+    size_t glyph_map_size;
+
+    //kerning table (open addressing, codepoint pair -> kerning)
+    kerning_pair_t * kerning_map;
+    size_t kerning_map_size;
+    size_t kerning_map_count;
+
 } texture_font_t;
 
 
@@ -435,6 +465,17 @@ typedef struct texture_font_t
                           const char * codepoint );
 
 
+/**
+ * Check if the glyph bitmap is still in the atlas.
+ *
+ * @param self A valid texture glyph
+ *
+ * @return One if the glyph is valid, zero if it was evicted.
+ */
+  int
+  texture_glyph_is_valid( const texture_glyph_t * self );
+
+
 /**
  * Request the loading of a given glyph.
  *
@@ -461,17 +502,58 @@ typedef struct texture_font_t
   texture_font_load_glyphs( texture_font_t * self,
                             const char * codepoints );
 
+/**
+ * Look up a glyph which has already been loaded.
+ *
+ * @param self      A valid texture font
+ * @param codepoint Character codepoint to be found in UTF-8 encoding.
+ *
+ * @return A pointer on the glyph or 0 if the glyph is not loaded
+ */
+  texture_glyph_t *
+  texture_font_find_glyph( texture_font_t * self,
+                           const char * codepoint );
+
 /**
  * Get the kerning between two horizontal glyphs.
  *
- * @param self      A valid texture glyph
- * @param codepoint Character codepoint of the peceding character in UTF-8 encoding.
+ * @param self  A valid texture font
+ * @param left  Codepoint of the preceding character in UTF-32 LE encoding.
+ * @param right Codepoint of the current character in UTF-32 LE encoding.
  *
  * @return x kerning value
  */
 float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint );
+texture_font_get_kerning( const texture_font_t * self,
+                          uint32_t left,
+                          uint32_t right );
+
+/**
+ * Set the kerning between two horizontal glyphs.
+ *
+ * @param self    A valid texture font
+ * @param left    Codepoint of the preceding character in UTF-32 LE encoding.
+ * @param right   Codepoint of the current character in UTF-32 LE encoding.
+ * @param kerning x kerning value
+ */
+void
+texture_font_set_kerning( texture_font_t * self,
+                          uint32_t left,
+                          uint32_t right,
+                          float kerning );
+
+/**
+ * Add a glyph which was rendered before (e.g. restored from a cache). The
+ * font takes ownership of the glyph.
+ *
+ * @param self  A valid texture font
+ * @param glyph A glyph stored in the atlas of the font
+ *
+ * @return One if the glyph was added, zero if not.
+ */
+int
+texture_font_insert_glyph( texture_font_t * self,
+                           texture_glyph_t * glyph );
 
 
 /**
@@ -482,6 +564,14 @@ texture_glyph_get_kerning( const texture_glyph_t * self,
 texture_glyph_t *
 texture_glyph_new( void );
 
+/**
+ * Deletes a glyph
+ *
+ * @param self a valid glyph
+ */
+void
+texture_glyph_delete( texture_glyph_t * self );
+
 /** @} */
 
 
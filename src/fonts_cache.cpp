@@ -0,0 +1,655 @@
+#include "fonts.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+#include <cstring>
+
+#define DEBUG_FONT_CACHE false
+
+//file format (native byte order)
+#define FONT_CACHE_MAGIC 0x414d4743 //AMGC
+#define FONT_CACHE_VERSION 3
+
+//atlas data alignment (memory pages)
+#define FONT_CACHE_DATA_ALIGN 4096
+
+/**
+ * Cache file header.
+ */
+struct font_cache_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fontHash;
+
+    //atlas config
+    uint32_t atlasSize;
+    uint32_t maxSize;
+    uint32_t maxPages;
+    uint32_t depth;
+    uint32_t renderMode;
+
+    //special glyph region (shared by all font sizes)
+    uint32_t specialPage; //UINT32_MAX: none
+    int32_t specialX;
+    int32_t specialY;
+
+    uint32_t pageCount;
+    uint32_t sizeCount;
+    uint64_t fileSize;
+};
+
+/**
+ * Atlas page.
+ */
+struct font_cache_page_t {
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t nodeCount;
+    uint64_t used;
+    uint64_t nodesOffset;
+    uint64_t dataOffset;
+};
+
+/**
+ * Font size.
+ */
+struct font_cache_size_t {
+    uint32_t size;
+    uint32_t glyphCount;
+    uint32_t kerningCount;
+    uint32_t reserved;
+    uint64_t glyphsOffset;
+    uint64_t kerningOffset;
+};
+
+/**
+ * Glyph metrics.
+ */
+struct font_cache_glyph_t {
+    uint32_t codepoint;
+    uint32_t page;
+    uint32_t width;
+    uint32_t height;
+    int32_t offsetX;
+    int32_t offsetY;
+    float advanceX;
+    float advanceY;
+    float s0;
+    float t0;
+    float s1;
+    float t1;
+    uint32_t glyphIndex;
+    int32_t renderMode;
+    float outlineThickness;
+    uint32_t reserved;
+};
+
+/**
+ * Kerning pair.
+ */
+struct font_cache_kerning_t {
+    uint64_t key;
+    float kerning;
+    uint32_t reserved;
+};
+
+/**
+ * Collected glyphs of a font size.
+ */
+struct font_cache_entry_t {
+    uint32_t size;
+    std::vector<font_cache_glyph_t> glyphs;
+    std::vector<font_cache_kerning_t> kerning;
+};
+
+/**
+ * FNV-1a hash of the font file.
+ */
+static uint64_t hashFontData(const char *data, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/**
+ * Align to the next multiple of align.
+ */
+static uint64_t alignOffset(uint64_t offset, uint64_t align) {
+    return (offset + align - 1) / align * align;
+}
+
+/**
+ * Append raw data to a buffer.
+ */
+static void appendData(std::vector<char> &buffer, const void *data, size_t len) {
+    const char *bytes = (const char *)data;
+
+    buffer.insert(buffer.end(), bytes, bytes + len);
+}
+
+/**
+ * Cache file of a font (one file per font data and atlas config).
+ */
+AminoFontCache::AminoFontCache(std::string dir, const char *fontData, size_t fontDataLen, texture_atlas_t *atlas, rendermode_t renderMode) {
+    fontHash = hashFontData(fontData, fontDataLen);
+    this->renderMode = renderMode;
+
+    //file name
+    char name[128];
+
+    snprintf(name, sizeof(name), "%016" PRIx64 "-%zu-%zu-%zu-%d.glyphs", fontHash, atlas->width, atlas->max_size, atlas->max_pages, (int)renderMode);
+
+    path = dir + "/" + name;
+}
+
+AminoFontCache::~AminoFontCache() {
+    unmap();
+}
+
+/**
+ * Unmap the cache file.
+ *
+ * Note: the atlas pages using the data have to be deleted before.
+ */
+void AminoFontCache::unmap() {
+    if (mapped) {
+        munmap(mapped, mappedLen);
+        mapped = NULL;
+        mappedLen = 0;
+    }
+
+    sizes.clear();
+}
+
+/**
+ * Map the cache file and use its pages in the atlas.
+ *
+ * Note: the atlas must not contain any glyphs yet.
+ */
+bool AminoFontCache::restoreAtlas(texture_atlas_t *atlas) {
+    assert(!atlas->next);
+    assert(atlas->used == 0);
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+        if (DEBUG_FONT_CACHE) {
+            printf("-> no font cache: %s\n", path.c_str());
+        }
+
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(font_cache_header_t)) {
+        close(fd);
+        return false;
+    }
+
+    //private mapping (modified pages are copied)
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    mapped = (char *)data;
+    mappedLen = st.st_size;
+
+    if (!validate(atlas)) {
+        printf("invalid font cache: %s\n", path.c_str());
+
+        unmap();
+        return false;
+    }
+
+    //pages
+    font_cache_header_t *header = (font_cache_header_t *)mapped;
+    font_cache_page_t *pages = (font_cache_page_t *)(header + 1);
+    texture_atlas_t *page = atlas;
+
+    for (uint32_t i = 0; i < header->pageCount; i++) {
+        if (i > 0) {
+            page = texture_atlas_add_page(atlas);
+            assert(page);
+        }
+
+        texture_atlas_set_data(page, (unsigned char *)(mapped + pages[i].dataOffset), pages[i].used, (const ivec3 *)(mapped + pages[i].nodesOffset), pages[i].nodeCount);
+        pageGenerations.push_back(page->generation);
+
+        //special glyph (new font sizes use the existing region)
+        if (i == header->specialPage) {
+            ivec4 region = {{ header->specialX, header->specialY, 5, 5 }};
+
+            atlas->special_page = page;
+            atlas->special_generation = page->generation;
+            atlas->special_region = region;
+        }
+    }
+
+    //sizes (glyphs are restored when used)
+    font_cache_size_t *sizeItems = (font_cache_size_t *)(pages + header->pageCount);
+
+    glyphCount = 0;
+
+    for (uint32_t i = 0; i < header->sizeCount; i++) {
+        sizes[sizeItems[i].size] = &sizeItems[i];
+        glyphCount += sizeItems[i].glyphCount;
+    }
+
+    savedState = getAtlasState(atlas);
+
+    if (DEBUG_FONT_CACHE) {
+        printf("-> font cache restored: %s (pages=%u, sizes=%u, glyphs=%zu)\n", path.c_str(), header->pageCount, header->sizeCount, glyphCount);
+    }
+
+    return true;
+}
+
+/**
+ * Get the modification state of all pages.
+ *
+ * Note: all counters only increase, the sum changes with each modification.
+ */
+uint64_t AminoFontCache::getAtlasState(texture_atlas_t *atlas) {
+    uint64_t state = atlas->evictions;
+
+    for (texture_atlas_t *page = atlas; page; page = page->next) {
+        state += 1 + page->version + page->generation;
+    }
+
+    return state;
+}
+
+/**
+ * Check if a file region is mapped.
+ */
+bool AminoFontCache::inRange(uint64_t offset, uint64_t len) {
+    return offset <= mappedLen && len <= mappedLen - offset;
+}
+
+/**
+ * Validate the mapped file.
+ */
+bool AminoFontCache::validate(texture_atlas_t *atlas) {
+    font_cache_header_t *header = (font_cache_header_t *)mapped;
+
+    if (header->magic != FONT_CACHE_MAGIC || header->version != FONT_CACHE_VERSION || header->fontHash != fontHash || header->fileSize != mappedLen) {
+        return false;
+    }
+
+    if (header->atlasSize != atlas->width || header->maxSize != atlas->max_size || header->maxPages != atlas->max_pages || header->depth != atlas->depth || header->renderMode != (uint32_t)renderMode) {
+        return false;
+    }
+
+    if (header->pageCount == 0 || header->pageCount > atlas->max_pages) {
+        return false;
+    }
+
+    if (!inRange(sizeof(font_cache_header_t), (uint64_t)header->pageCount * sizeof(font_cache_page_t) + (uint64_t)header->sizeCount * sizeof(font_cache_size_t))) {
+        return false;
+    }
+
+    //pages (same sizes as texture_atlas_add_page())
+    font_cache_page_t *pages = (font_cache_page_t *)(header + 1);
+    size_t size = atlas->width;
+
+    for (uint32_t i = 0; i < header->pageCount; i++) {
+        font_cache_page_t *page = &pages[i];
+
+        if (i > 0) {
+            size = std::max(std::min(size * 2, atlas->max_size), size);
+        }
+
+        if (page->width != size || page->height != size || page->depth != atlas->depth || page->nodeCount == 0) {
+            return false;
+        }
+
+        if (!inRange(page->nodesOffset, (uint64_t)page->nodeCount * sizeof(ivec3)) || !inRange(page->dataOffset, (uint64_t)size * size * page->depth)) {
+            return false;
+        }
+
+        //skyline nodes (x, y, width) have to be inside of the page
+        const ivec3 *nodes = (const ivec3 *)(mapped + page->nodesOffset);
+
+        for (uint32_t j = 0; j < page->nodeCount; j++) {
+            const ivec3 *node = &nodes[j];
+
+            if (node->x < 0 || node->y < 0 || node->z < 0 || (uint64_t)node->x + node->z > size || (uint64_t)node->y > size) {
+                return false;
+            }
+        }
+    }
+
+    //special glyph region (5x5)
+    if (header->specialPage != UINT32_MAX) {
+        if (header->specialPage >= header->pageCount) {
+            return false;
+        }
+
+        uint32_t pageSize = pages[header->specialPage].width;
+
+        if (header->specialX < 0 || header->specialY < 0 || (uint64_t)header->specialX + 5 > pageSize || (uint64_t)header->specialY + 5 > pageSize) {
+            return false;
+        }
+    }
+
+    //sizes
+    font_cache_size_t *sizeItems = (font_cache_size_t *)(pages + header->pageCount);
+
+    for (uint32_t i = 0; i < header->sizeCount; i++) {
+        font_cache_size_t *item = &sizeItems[i];
+
+        if (!inRange(item->glyphsOffset, (uint64_t)item->glyphCount * sizeof(font_cache_glyph_t)) || !inRange(item->kerningOffset, (uint64_t)item->kerningCount * sizeof(font_cache_kerning_t))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Add the cached glyphs to a new font size.
+ *
+ * Note: glyph lock has to be held.
+ */
+void AminoFontCache::restoreGlyphs(texture_font_t *fontSize, uint32_t size) {
+    std::map<uint32_t, const font_cache_size_t *>::iterator it = sizes.find(size);
+
+    if (it == sizes.end()) {
+        return;
+    }
+
+    const font_cache_size_t *item = it->second;
+    const font_cache_glyph_t *glyphs = (const font_cache_glyph_t *)(mapped + item->glyphsOffset);
+    const font_cache_kerning_t *kerning = (const font_cache_kerning_t *)(mapped + item->kerningOffset);
+
+    //pages
+    std::vector<texture_atlas_t *> pages;
+
+    for (texture_atlas_t *page = fontSize->atlas; page; page = page->next) {
+        pages.push_back(page);
+    }
+
+    for (uint32_t i = 0; i < item->glyphCount; i++) {
+        const font_cache_glyph_t *cached = &glyphs[i];
+
+        //skip evicted pages
+        if (cached->page >= pageGenerations.size() || pages[cached->page]->generation != pageGenerations[cached->page]) {
+            continue;
+        }
+
+        texture_glyph_t *glyph = texture_glyph_new();
+
+        if (!glyph) {
+            break;
+        }
+
+        glyph->codepoint = cached->codepoint;
+        glyph->width = cached->width;
+        glyph->height = cached->height;
+        glyph->offset_x = cached->offsetX;
+        glyph->offset_y = cached->offsetY;
+        glyph->advance_x = cached->advanceX;
+        glyph->advance_y = cached->advanceY;
+        glyph->s0 = cached->s0;
+        glyph->t0 = cached->t0;
+        glyph->s1 = cached->s1;
+        glyph->t1 = cached->t1;
+        glyph->glyph_index = cached->glyphIndex;
+        glyph->rendermode = (rendermode_t)cached->renderMode;
+        glyph->outline_thickness = cached->outlineThickness;
+        glyph->atlas = pages[cached->page];
+        glyph->generation = glyph->atlas->generation;
+
+        if (!texture_font_insert_glyph(fontSize, glyph)) {
+            texture_glyph_delete(glyph);
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < item->kerningCount; i++) {
+        texture_font_set_kerning(fontSize, kerning[i].key >> 32, kerning[i].key & 0xffffffff, kerning[i].kerning);
+    }
+
+    //size is saved from the font from now on
+    sizes.erase(it);
+}
+
+/**
+ * Write the atlas and glyphs of all font sizes.
+ *
+ * Note: glyph lock has to be held. Only writes the file if glyphs were added.
+ */
+bool AminoFontCache::save(texture_atlas_t *atlas, std::map<uint32_t, texture_font_t *> &fontSizes) {
+    //check modifications (new glyphs or evictions)
+    uint64_t state = getAtlasState(atlas);
+
+    if (state == savedState) {
+        //unchanged
+        return true;
+    }
+
+    //pages
+    std::vector<texture_atlas_t *> pages;
+
+    for (texture_atlas_t *page = atlas; page; page = page->next) {
+        pages.push_back(page);
+    }
+
+    //collect glyphs
+    std::vector<font_cache_entry_t> entries;
+    size_t count = 0;
+
+    for (std::map<uint32_t, texture_font_t *>::iterator it = fontSizes.begin(); it != fontSizes.end(); it++) {
+        texture_font_t *fontSize = it->second;
+        font_cache_entry_t entry;
+
+        entry.size = it->first;
+
+        for (size_t i = 0; i < fontSize->glyphs->size; i++) {
+            texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(fontSize->glyphs, i);
+
+            //skip special glyph (region is saved in header)
+            if (glyph->codepoint == UINT32_MAX || !texture_glyph_is_valid(glyph)) {
+                continue;
+            }
+
+            font_cache_glyph_t cached;
+
+            cached.codepoint = glyph->codepoint;
+            cached.page = glyph->atlas->page;
+            cached.width = glyph->width;
+            cached.height = glyph->height;
+            cached.offsetX = glyph->offset_x;
+            cached.offsetY = glyph->offset_y;
+            cached.advanceX = glyph->advance_x;
+            cached.advanceY = glyph->advance_y;
+            cached.s0 = glyph->s0;
+            cached.t0 = glyph->t0;
+            cached.s1 = glyph->s1;
+            cached.t1 = glyph->t1;
+            cached.glyphIndex = glyph->glyph_index;
+            cached.renderMode = glyph->rendermode;
+            cached.outlineThickness = glyph->outline_thickness;
+            cached.reserved = 0;
+
+            entry.glyphs.push_back(cached);
+        }
+
+        for (size_t i = 0; i < fontSize->kerning_map_size; i++) {
+            kerning_pair_t *pair = &fontSize->kerning_map[i];
+
+            if (pair->key == KERNING_MAP_EMPTY) {
+                continue;
+            }
+
+            font_cache_kerning_t cached;
+
+            cached.key = pair->key;
+            cached.kerning = pair->kerning;
+            cached.reserved = 0;
+
+            entry.kerning.push_back(cached);
+        }
+
+        count += entry.glyphs.size();
+        entries.push_back(entry);
+    }
+
+    //keep the cached sizes which were not used
+    for (std::map<uint32_t, const font_cache_size_t *>::iterator it = sizes.begin(); it != sizes.end(); it++) {
+        const font_cache_size_t *item = it->second;
+        const font_cache_glyph_t *glyphs = (const font_cache_glyph_t *)(mapped + item->glyphsOffset);
+        const font_cache_kerning_t *kerning = (const font_cache_kerning_t *)(mapped + item->kerningOffset);
+        font_cache_entry_t entry;
+
+        entry.size = item->size;
+
+        for (uint32_t i = 0; i < item->glyphCount; i++) {
+            if (glyphs[i].page < pageGenerations.size() && pages[glyphs[i].page]->generation == pageGenerations[glyphs[i].page]) {
+                entry.glyphs.push_back(glyphs[i]);
+            }
+        }
+
+        entry.kerning.assign(kerning, kerning + item->kerningCount);
+
+        count += entry.glyphs.size();
+        entries.push_back(entry);
+    }
+
+    //header and tables
+    std::vector<char> buffer;
+    font_cache_header_t header;
+    uint64_t offset = sizeof(font_cache_header_t) + pages.size() * sizeof(font_cache_page_t) + entries.size() * sizeof(font_cache_size_t);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = FONT_CACHE_MAGIC;
+    header.version = FONT_CACHE_VERSION;
+    header.fontHash = fontHash;
+    header.atlasSize = atlas->width;
+    header.maxSize = atlas->max_size;
+    header.maxPages = atlas->max_pages;
+    header.depth = atlas->depth;
+    header.renderMode = renderMode;
+    header.specialPage = UINT32_MAX;
+
+    if (atlas->special_page && atlas->special_page->generation == atlas->special_generation) {
+        header.specialPage = atlas->special_page->page;
+        header.specialX = atlas->special_region.x;
+        header.specialY = atlas->special_region.y;
+    }
+    header.pageCount = pages.size();
+    header.sizeCount = entries.size();
+
+    std::vector<font_cache_size_t> sizeItems;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        font_cache_size_t item;
+
+        memset(&item, 0, sizeof(item));
+        item.size = entries[i].size;
+        item.glyphCount = entries[i].glyphs.size();
+        item.glyphsOffset = offset;
+        offset += item.glyphCount * sizeof(font_cache_glyph_t);
+        item.kerningCount = entries[i].kerning.size();
+        item.kerningOffset = offset;
+        offset += item.kerningCount * sizeof(font_cache_kerning_t);
+
+        sizeItems.push_back(item);
+    }
+
+    std::vector<font_cache_page_t> pageItems;
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        font_cache_page_t item;
+
+        memset(&item, 0, sizeof(item));
+        item.width = pages[i]->width;
+        item.height = pages[i]->height;
+        item.depth = pages[i]->depth;
+        item.used = pages[i]->used;
+        item.nodeCount = pages[i]->nodes->size;
+        item.nodesOffset = offset;
+        offset += item.nodeCount * sizeof(ivec3);
+
+        pageItems.push_back(item);
+    }
+
+    //page data (aligned)
+    for (size_t i = 0; i < pages.size(); i++) {
+        offset = alignOffset(offset, FONT_CACHE_DATA_ALIGN);
+        pageItems[i].dataOffset = offset;
+        offset += pages[i]->width * pages[i]->height * pages[i]->depth;
+    }
+
+    header.fileSize = offset;
+
+    appendData(buffer, &header, sizeof(header));
+    appendData(buffer, pageItems.data(), pageItems.size() * sizeof(font_cache_page_t));
+    appendData(buffer, sizeItems.data(), sizeItems.size() * sizeof(font_cache_size_t));
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        appendData(buffer, entries[i].glyphs.data(), entries[i].glyphs.size() * sizeof(font_cache_glyph_t));
+        appendData(buffer, entries[i].kerning.data(), entries[i].kerning.size() * sizeof(font_cache_kerning_t));
+    }
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        appendData(buffer, pages[i]->nodes->items, pageItems[i].nodeCount * sizeof(ivec3));
+    }
+
+    //write temporary file (mapped file stays valid)
+    std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+
+    if (!file) {
+        printf("could not write font cache: %s\n", tmpPath.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    uint64_t pos = buffer.size();
+
+    for (size_t i = 0; i < pages.size() && ok; i++) {
+        size_t len = pages[i]->width * pages[i]->height * pages[i]->depth;
+
+        //padding
+        if (fseek(file, pageItems[i].dataOffset - pos, SEEK_CUR) != 0) {
+            ok = false;
+            break;
+        }
+
+        ok = fwrite(pages[i]->data, 1, len, file) == len;
+        pos = pageItems[i].dataOffset + len;
+    }
+
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        printf("could not write font cache: %s\n", path.c_str());
+        unlink(tmpPath.c_str());
+
+        return false;
+    }
+
+    glyphCount = count;
+    savedState = state;
+
+    if (DEBUG_FONT_CACHE) {
+        printf("-> font cache saved: %s (pages=%zu, sizes=%zu, glyphs=%zu)\n", path.c_str(), pages.size(), entries.size(), count);
+    }
+
+    return true;
+}
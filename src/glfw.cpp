@@ -588,6 +588,7 @@ private:
         //get framebuffer size
         glfwGetFramebufferSize(window, &viewportW, &viewportH);
         viewportChanged = true;
+        requestRender();
 
         //check framebuffer size
         if (DEBUG_GLFW) {
@@ -845,6 +846,7 @@ private:
 
         glfwGetFramebufferSize(window, &viewportW, &viewportH);
         viewportChanged = true;
+        requestRender();
 
         //check framebuffer size
         if (DEBUG_GLFW) {
@@ -1002,6 +1004,7 @@ private:
         //get framebuffer size
         glfwGetFramebufferSize(window, &viewportW, &viewportH);
         viewportChanged = true;
+        requestRender();
 
         //check framebuffer size
         if (DEBUG_GLFW) {
@@ -1347,6 +1350,7 @@ void AminoGlfwVideoPlayer::initDemuxer() {
 
         //show
         demuxer->switchDecodedFrame();
+        handleFrameAvailable();
 
         //update media time
         mediaTime = getTime() / 1000 - timeStartSys;
@@ -1040,6 +1040,7 @@ void AminoTexture::createTexture(AsyncValueUpdate *update, int state) {
 
             w = img->w;
             h = img->h;
+            version++;
 
             if (newTexture) {
                (static_cast<AminoGfx *>(eventHandler))->notifyTextureCreated(1);
@@ -1394,6 +1395,25 @@ void AminoTexture::prepareTexture(GLContext *ctx) {
     uv_mutex_unlock(&videoLock);
 }
 
+/**
+ * Check if a video is being played.
+ *
+ * Note: called on rendering thread.
+ */
+bool AminoTexture::isVideoPlaying() {
+    if (!videoLockUsed) {
+        return false;
+    }
+
+    uv_mutex_lock(&videoLock);
+
+    bool playing = videoPlayer && videoPlayer->isPlaying();
+
+    uv_mutex_unlock(&videoLock);
+
+    return playing;
+}
+
 /**
  * Fire video event.
  */
@@ -1512,6 +1532,7 @@ void AminoTexture::createTextureFromBuffer(AsyncValueUpdate *update, int state)
 
             w = textureData->w;
             h = textureData->h;
+            version++;
 
             if (newTexture) {
                 (static_cast<AminoGfx *>(eventHandler))->notifyTextureCreated(1);
@@ -1616,7 +1637,7 @@ void AminoTexture::createTextureFromFont(AsyncValueUpdate *update, int state) {
         //use current font texture
         texture_atlas_t *atlas = fontSize->fontTexture->atlas;
         bool newTexture;
-        GLuint textureId = (static_cast<AminoGfx *>(eventHandler))->getAtlasTexture(atlas, true, newTexture).textureId;
+        GLuint textureId = (static_cast<AminoGfx *>(eventHandler))->getAtlasTexture(atlas, true, newTexture)->textureId;
 
         if (textureId != INVALID_TEXTURE) {
             //set values
@@ -1630,6 +1651,7 @@ void AminoTexture::createTextureFromFont(AsyncValueUpdate *update, int state) {
 
             w = atlas->width;
             h = atlas->height;
+            version++;
         } else {
             activeTexture = -1;
         }
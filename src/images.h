@@ -71,6 +71,7 @@ public:
     bool ownTexture = true;
     int w = 0;
     int h = 0;
+    uint32_t version = 0; //content changes (rendering thread)
 
     AminoTexture();
     ~AminoTexture();
@@ -91,6 +92,7 @@ public:
     void initVideoTexture();
     void videoPlayerInitDone();
     void prepareTexture(GLContext *ctx);
+    bool isVideoPlaying();
     void fireVideoEvent(std::string event);
 
 private:
@@ -1,5 +1,16 @@
 #include "mathutils.h"
 
+//SIMD support (scalar fallback)
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+
+    #define MATH_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+
+    #define MATH_NEON
+#endif
+
 /**
  * Reset 4x4 matrix with zero values.
  */
@@ -338,9 +349,54 @@ bool make_square_to_quad_matrix(GLfloat dx0, GLfloat dy0, GLfloat dx1, GLfloat d
 /**
  * Matrix multiplication (4x4).
  *
+ * Note: prod can be the same as a or b.
+ *
  * @param prod result
  */
 void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
+#if defined(MATH_SSE)
+    //columns of a
+    __m128 a0 = _mm_loadu_ps(a);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+    __m128 p[4];
+
+    for (int i = 0; i < 4; i++) {
+        const GLfloat *bi = b + (i << 2);
+
+        p[i] = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bi[0])), _mm_mul_ps(a1, _mm_set1_ps(bi[1]))),
+            _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bi[2])), _mm_mul_ps(a3, _mm_set1_ps(bi[3])))
+        );
+    }
+
+    _mm_storeu_ps(prod, p[0]);
+    _mm_storeu_ps(prod + 4, p[1]);
+    _mm_storeu_ps(prod + 8, p[2]);
+    _mm_storeu_ps(prod + 12, p[3]);
+#elif defined(MATH_NEON)
+    //columns of a
+    float32x4_t a0 = vld1q_f32(a);
+    float32x4_t a1 = vld1q_f32(a + 4);
+    float32x4_t a2 = vld1q_f32(a + 8);
+    float32x4_t a3 = vld1q_f32(a + 12);
+    float32x4_t p[4];
+
+    for (int i = 0; i < 4; i++) {
+        float32x4_t bi = vld1q_f32(b + (i << 2));
+
+        p[i] = vmulq_lane_f32(a0, vget_low_f32(bi), 0);
+        p[i] = vmlaq_lane_f32(p[i], a1, vget_low_f32(bi), 1);
+        p[i] = vmlaq_lane_f32(p[i], a2, vget_high_f32(bi), 0);
+        p[i] = vmlaq_lane_f32(p[i], a3, vget_high_f32(bi), 1);
+    }
+
+    vst1q_f32(prod, p[0]);
+    vst1q_f32(prod + 4, p[1]);
+    vst1q_f32(prod + 8, p[2]);
+    vst1q_f32(prod + 12, p[3]);
+#else
 #define A(row,col)  a[(col<<2)+row]
 #define B(row,col)  b[(col<<2)+row]
 #define P(row,col)  p[(col<<2)+row]
@@ -359,7 +415,125 @@ void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
    memcpy(prod, p, sizeof p);
 #undef A
 #undef B
-#undef PROD
+#undef P
+#endif
+}
+
+/**
+ * Create node transformation matrix.
+ *
+ * Combines: translate(origin) * translate(x, y, z) * scale(sx, sy) * rotate(rx, ry, rz) * translate(-origin)
+ *
+ * Note: identity components (no rotation, no scaling) are skipped.
+ *
+ * @param m result
+ * @return false if the result is the identity matrix
+ */
+bool make_trs_matrix(GLfloat ox, GLfloat oy, GLfloat x, GLfloat y, GLfloat z, GLfloat sx, GLfloat sy, GLfloat rx, GLfloat ry, GLfloat rz, GLfloat *m) {
+    //rotation (3x3 columns)
+    GLfloat c0[3] = { 1.f, 0.f, 0.f };
+    GLfloat c1[3] = { 0.f, 1.f, 0.f };
+    GLfloat c2[3] = { 0.f, 0.f, 1.f };
+    bool identity = true;
+
+    //x-rotation
+    if (rx != 0) {
+        float rad = rx * M_PI / 180.0f;
+        float c = cos(rad);
+        float s = sin(rad);
+
+        for (int i = 0; i < 3; i++) {
+            GLfloat v1 = c1[i];
+            GLfloat v2 = c2[i];
+
+            c1[i] = c * v1 + s * v2;
+            c2[i] = c * v2 - s * v1;
+        }
+
+        identity = false;
+    }
+
+    //y-rotation
+    if (ry != 0) {
+        float rad = ry * M_PI / 180.0f;
+        float c = cos(rad);
+        float s = sin(rad);
+
+        for (int i = 0; i < 3; i++) {
+            GLfloat v0 = c0[i];
+            GLfloat v2 = c2[i];
+
+            c0[i] = c * v0 - s * v2;
+            c2[i] = s * v0 + c * v2;
+        }
+
+        identity = false;
+    }
+
+    //z-rotation
+    if (rz != 0) {
+        float rad = rz * M_PI / 180.0f;
+        float c = cos(rad);
+        float s = sin(rad);
+
+        for (int i = 0; i < 3; i++) {
+            GLfloat v0 = c0[i];
+            GLfloat v1 = c1[i];
+
+            c0[i] = c * v0 + s * v1;
+            c1[i] = c * v1 - s * v0;
+        }
+
+        identity = false;
+    }
+
+    //scale
+    if (sx != 1) {
+        c0[0] *= sx;
+        c1[0] *= sx;
+        c2[0] *= sx;
+
+        identity = false;
+    }
+
+    if (sy != 1) {
+        c0[1] *= sy;
+        c1[1] *= sy;
+        c2[1] *= sy;
+
+        identity = false;
+    }
+
+    //linear part
+    m[0] = c0[0];
+    m[1] = c0[1];
+    m[2] = c0[2];
+    m[3] = 0.f;
+
+    m[4] = c1[0];
+    m[5] = c1[1];
+    m[6] = c1[2];
+    m[7] = 0.f;
+
+    m[8] = c2[0];
+    m[9] = c2[1];
+    m[10] = c2[2];
+    m[11] = 0.f;
+
+    //translation (origin is only relevant if rotated or scaled)
+    if (identity) {
+        m[12] = x;
+        m[13] = y;
+        m[14] = z;
+    } else {
+        m[12] = ox + x - (c0[0] * ox + c1[0] * oy);
+        m[13] = oy + y - (c0[1] * ox + c1[1] * oy);
+        m[14] = z - (c0[2] * ox + c1[2] * oy);
+    }
+
+    m[15] = 1.f;
+
+    return !identity || x != 0 || y != 0 || z != 0;
 }
 
 /**
@@ -400,9 +574,21 @@ void loadOrthoMatrix(GLfloat *modelView, GLfloat left, GLfloat right, GLfloat bo
  * Copy a matrix.
  */
 void copy_matrix(GLfloat *dst, const GLfloat *src) {
+#if defined(MATH_SSE)
+    _mm_storeu_ps(dst, _mm_loadu_ps(src));
+    _mm_storeu_ps(dst + 4, _mm_loadu_ps(src + 4));
+    _mm_storeu_ps(dst + 8, _mm_loadu_ps(src + 8));
+    _mm_storeu_ps(dst + 12, _mm_loadu_ps(src + 12));
+#elif defined(MATH_NEON)
+    vst1q_f32(dst, vld1q_f32(src));
+    vst1q_f32(dst + 4, vld1q_f32(src + 4));
+    vst1q_f32(dst + 8, vld1q_f32(src + 8));
+    vst1q_f32(dst + 12, vld1q_f32(src + 12));
+#else
     for (int i = 0; i < 16; i++) {
         dst[i] = src[i];
     }
+#endif
 }
 
 /**
@@ -541,6 +727,79 @@ void transpose_matrix(GLfloat *b, const GLfloat *a) {
  * Invert a matrix.
  */
 bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
+#if defined(MATH_SSE)
+    /*
+     * Block matrix inversion using 2x2 sub matrices.
+     *
+     * Note: works for column-major matrices too (inverse of transposed matrix is the transposed inverse).
+     */
+
+    #define SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+    #define SWIZZLE(a, x, y, z, w) SHUFFLE(a, a, x, y, z, w)
+
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+
+    //sub matrices
+    __m128 A = _mm_movelh_ps(r0, r1);
+    __m128 B = _mm_movehl_ps(r1, r0);
+    __m128 C = _mm_movelh_ps(r2, r3);
+    __m128 D = _mm_movehl_ps(r3, r2);
+
+    //determinants (|A| |B| |C| |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(SHUFFLE(r0, r2, 0, 2, 0, 2), SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(SHUFFLE(r0, r2, 1, 3, 1, 3), SHUFFLE(r1, r3, 0, 2, 0, 2))
+    );
+    __m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+
+    //adjugate products: D#C, A#B
+    __m128 D_C = _mm_sub_ps(_mm_mul_ps(SWIZZLE(D, 3, 3, 0, 0), C), _mm_mul_ps(SWIZZLE(D, 1, 1, 2, 2), SWIZZLE(C, 2, 3, 0, 1)));
+    __m128 A_B = _mm_sub_ps(_mm_mul_ps(SWIZZLE(A, 3, 3, 0, 0), B), _mm_mul_ps(SWIZZLE(A, 1, 1, 2, 2), SWIZZLE(B, 2, 3, 0, 1)));
+
+    //X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+    __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), _mm_add_ps(_mm_mul_ps(B, SWIZZLE(D_C, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(B, 1, 0, 3, 2), SWIZZLE(D_C, 2, 1, 2, 1))));
+    __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), _mm_add_ps(_mm_mul_ps(C, SWIZZLE(A_B, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(C, 1, 0, 3, 2), SWIZZLE(A_B, 2, 1, 2, 1))));
+
+    //Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+    __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), _mm_sub_ps(_mm_mul_ps(D, SWIZZLE(A_B, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(D, 1, 0, 3, 2), SWIZZLE(A_B, 2, 1, 2, 1))));
+    __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), _mm_sub_ps(_mm_mul_ps(A, SWIZZLE(D_C, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(A, 1, 0, 3, 2), SWIZZLE(D_C, 2, 1, 2, 1))));
+
+    //|M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    __m128 tr = _mm_mul_ps(A_B, SWIZZLE(D_C, 0, 2, 1, 3));
+
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ss(tr, SWIZZLE(tr, 1, 1, 1, 1));
+
+    GLfloat det = _mm_cvtss_f32(detA) * _mm_cvtss_f32(detD) + _mm_cvtss_f32(detB) * _mm_cvtss_f32(detC) - _mm_cvtss_f32(tr);
+
+    if (det == 0) {
+        return false;
+    }
+
+    __m128 rDet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), _mm_set1_ps(det));
+
+    X_ = _mm_mul_ps(X_, rDet);
+    Y_ = _mm_mul_ps(Y_, rDet);
+    Z_ = _mm_mul_ps(Z_, rDet);
+    W_ = _mm_mul_ps(W_, rDet);
+
+    //adjugate
+    _mm_storeu_ps(invOut, SHUFFLE(X_, Y_, 3, 1, 3, 1));
+    _mm_storeu_ps(invOut + 4, SHUFFLE(X_, Y_, 2, 0, 2, 0));
+    _mm_storeu_ps(invOut + 8, SHUFFLE(Z_, W_, 3, 1, 3, 1));
+    _mm_storeu_ps(invOut + 12, SHUFFLE(Z_, W_, 2, 0, 2, 0));
+
+    #undef SHUFFLE
+    #undef SWIZZLE
+
+    return true;
+#else
     //see http://stackoverflow.com/questions/1148309/inverting-a-4x4-matrix
     GLfloat inv[16], det;
     int i;
@@ -670,4 +929,5 @@ bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
     }
 
     return true;
+#endif
 }
\ No newline at end of file
@@ -34,6 +34,7 @@ bool make_quad_to_square_matrix(GLfloat sx0, GLfloat sy0, GLfloat sx1, GLfloat s
 bool make_square_to_quad_matrix(GLfloat dx0, GLfloat dy0, GLfloat dx1, GLfloat dy1, GLfloat dx2, GLfloat dy2, GLfloat dx3, GLfloat dy3, GLfloat *matrix);
 
 void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b);
+bool make_trs_matrix(GLfloat ox, GLfloat oy, GLfloat x, GLfloat y, GLfloat z, GLfloat sx, GLfloat sy, GLfloat rx, GLfloat ry, GLfloat rz, GLfloat *m);
 
 void loadOrthoMatrix(GLfloat *modelView, GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat near, GLfloat far);
 
@@ -1,5 +1,9 @@
 #include "renderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #define DEBUG_RENDERER false
 #define DEBUG_RENDERER_ERRORS false
 #define DEBUG_FONT_PERFORMANCE 0
@@ -32,11 +36,17 @@ AminoRenderer::~AminoRenderer () {
         textureShader = NULL;
     }
 
-    //texture clamp to border shader
-    if (textureClampToBorderShader) {
-        textureClampToBorderShader->destroy();
-        delete textureClampToBorderShader;
-        textureClampToBorderShader = NULL;
+    //unit quad shaders
+    if (quadShader) {
+        quadShader->destroy();
+        delete quadShader;
+        quadShader = NULL;
+    }
+
+    if (quadTextureShader) {
+        quadTextureShader->destroy();
+        delete quadTextureShader;
+        quadTextureShader = NULL;
     }
 
     //font shader
@@ -46,6 +56,12 @@ AminoRenderer::~AminoRenderer () {
         fontShader = NULL;
     }
 
+    if (sdfFontShader) {
+        sdfFontShader->destroy();
+        delete sdfFontShader;
+        sdfFontShader = NULL;
+    }
+
     //color lighting shader
     if (colorLightingShader) {
         colorLightingShader->destroy();
@@ -60,6 +76,48 @@ AminoRenderer::~AminoRenderer () {
         textureLightingShader = NULL;
     }
 
+    //batch shaders
+    if (batchShader) {
+        batchShader->destroy();
+        delete batchShader;
+        batchShader = NULL;
+    }
+
+    if (batchTextureShader) {
+        batchTextureShader->destroy();
+        delete batchTextureShader;
+        batchTextureShader = NULL;
+    }
+
+    //batch buffer
+    if (batchBuffer != INVALID_BUFFER) {
+        glDeleteBuffers(1, &batchBuffer);
+        batchBuffer = INVALID_BUFFER;
+    }
+
+    //unit quad buffers
+#if defined RPI && defined GL_OES_vertex_array_object
+    if (quadVao != INVALID_BUFFER) {
+        deleteVertexArrays(1, &quadVao);
+        quadVao = INVALID_BUFFER;
+    }
+
+    if (quadTextureVao != INVALID_BUFFER) {
+        deleteVertexArrays(1, &quadTextureVao);
+        quadTextureVao = INVALID_BUFFER;
+    }
+#endif
+
+    if (quadBuffer != INVALID_BUFFER) {
+        glDeleteBuffers(1, &quadBuffer);
+        quadBuffer = INVALID_BUFFER;
+    }
+
+    if (quadIndexBuffer != INVALID_BUFFER) {
+        glDeleteBuffers(1, &quadIndexBuffer);
+        quadIndexBuffer = INVALID_BUFFER;
+    }
+
     //context
     if (ctx) {
         delete ctx;
@@ -97,6 +155,32 @@ void AminoRenderer::setup() {
 
     assert(res);
 
+    //batch shaders
+    batchShader = new BatchShader();
+    res = batchShader->create();
+
+    assert(res);
+
+    batchTextureShader = new BatchTextureShader();
+    res = batchTextureShader->create();
+
+    assert(res);
+
+    //batch buffer
+    glGenBuffers(1, &batchBuffer);
+
+    assert(batchBuffer != INVALID_BUFFER);
+
+    batchVertices.reserve(6 * 256);
+
+    //unit quad
+    quadShader = new QuadShader();
+    res = quadShader->create();
+
+    assert(res);
+
+    initQuadBuffer();
+
     //context
     ctx = new GLContext();
 }
@@ -313,6 +397,13 @@ void AminoRenderer::updateViewport(GLfloat width, GLfloat height, GLfloat viewpo
 
     //set viewport
     glViewport(0, 0, viewportW, viewportH);
+
+    viewportSize[0] = viewportW;
+    viewportSize[1] = viewportH;
+
+    //redraw everything
+    damageAll = true;
+    viewVersion++;
 }
 
 /**
@@ -323,9 +414,25 @@ void AminoRenderer::initScene(GLfloat r, GLfloat g, GLfloat b, GLfloat opacity)
     glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_TRUE);
 
-    //prepare
+    //damaged region only
+    scissorTest = damagePartial;
+
+    if (scissorTest) {
+        memcpy(scissor, damageRect, sizeof(scissor));
+
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+    } else {
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    //prepare (Note: clearing all buffers at once is cheap)
     glClearColor(r, g, b, opacity);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glStencilMask(0xFF);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    stencilRef = 0;
+    stencilCounter = 0;
 
     //disable depth mask (use painter's algorithm by default)
     glDepthMask(GL_FALSE);
@@ -339,70 +446,589 @@ void AminoRenderer::renderScene(AminoNode *node) {
         printf("-> renderScene()\n");
     }
 
-    render(node);
+    if (node == NULL) {
+        printf("WARNING. NULL NODE!\n");
+        return;
+    }
+
+    //record all commands (root changed)
+    if (recordAll) {
+        commands.clear();
+        recordNode(node, NULL, commands);
+        recordAll = false;
+    }
+
+    //screen bounds (if not done by updateDamage())
+    if (!boundsUpdated && culling) {
+        updateBounds();
+    }
+
+    boundsUpdated = false;
+
+    //replay
+    renderCommands();
+
+    //draw remaining quads
+    flushBatch();
 
     ctx->reset();
 }
 
 /**
- * Render a node.
+ * Empty bounds.
  */
-void AminoRenderer::render(AminoNode *root) {
-    if (DEBUG_RENDERER) {
-        printf("-> render()\n");
-    }
+static void clear_bounds(GLfloat *bounds) {
+    bounds[0] = 0;
+    bounds[1] = 0;
+    bounds[2] = -1;
+    bounds[3] = -1;
+}
 
-    if (root == NULL) {
-        printf("WARNING. NULL NODE!\n");
+/**
+ * Check for empty bounds.
+ */
+static bool is_empty_bounds(GLfloat *bounds) {
+    return bounds[0] > bounds[2] || bounds[1] > bounds[3];
+}
+
+/**
+ * Extend bounds.
+ */
+static void union_bounds(GLfloat *dest, GLfloat *bounds) {
+    if (is_empty_bounds(bounds)) {
         return;
     }
 
-    //skip non-visible nodes
-    if (!root->propVisible->value) {
+    if (is_empty_bounds(dest)) {
+        memcpy(dest, bounds, 4 * sizeof(GLfloat));
         return;
     }
 
-    ctx->save();
+    dest[0] = fminf(dest[0], bounds[0]);
+    dest[1] = fminf(dest[1], bounds[1]);
+    dest[2] = fmaxf(dest[2], bounds[2]);
+    dest[3] = fmaxf(dest[3], bounds[3]);
+}
+
+/**
+ * Limit bounds.
+ */
+static void intersect_bounds(GLfloat *dest, GLfloat *bounds) {
+    dest[0] = fmaxf(dest[0], bounds[0]);
+    dest[1] = fmaxf(dest[1], bounds[1]);
+    dest[2] = fminf(dest[2], bounds[2]);
+    dest[3] = fminf(dest[3], bounds[3]);
+}
 
-    //transform
-    if (root->propW) {
-        //apply origin
-        ctx->translate(root->propW->value * root->propOriginX->value, root->propH->value * root->propOriginY->value);
+/**
+ * Check if bounds overlap.
+ */
+static bool overlaps_bounds(GLfloat *bounds1, GLfloat *bounds2) {
+    return !is_empty_bounds(bounds1) && !is_empty_bounds(bounds2) &&
+           bounds1[0] < bounds2[2] && bounds1[2] > bounds2[0] &&
+           bounds1[1] < bounds2[3] && bounds1[3] > bounds2[1];
+}
+
+/**
+ * Enable or disable culling (screen bounds are only updated if culling or damage tracking is used).
+ */
+void AminoRenderer::setCulling(bool enabled) {
+    culling = enabled;
+}
+
+/**
+ * Find the damaged screen region (call before rendering the scene).
+ *
+ * Returns true if only the region in rect (x, y, w, h) has to be redrawn.
+ */
+bool AminoRenderer::updateDamage(AminoNode *node, int bufferAge, GLfloat threshold, GLint *rect) {
+    damagePartial = false;
+
+    if (node == NULL) {
+        return false;
     }
 
-    ctx->translate(root->propX->value, root->propY->value, root->propZ->value);
-    ctx->scale(root->propScaleX->value, root->propScaleY->value);
-    ctx->rotate(root->propRotateX->value, root->propRotateY->value, root->propRotateZ->value);
+    //record all commands (root changed)
+    if (recordAll) {
+        commands.clear();
+        recordNode(node, NULL, commands);
+        recordAll = false;
+        damageAll = true;
+    }
+
+    //changes of this frame
+    clear_bounds(frameDamage);
+    updateBounds();
+
+    GLfloat viewport[4] = { 0, 0, viewportSize[0], viewportSize[1] };
 
-    if (root->propW) {
-        //apply origin
-        ctx->translate(- (root->propW->value* root->propOriginX->value), - (root->propH->value * root->propOriginY->value));
+    if (damageAll) {
+        damageAll = false;
+        memcpy(frameDamage, viewport, sizeof(viewport));
     }
 
-    //draw
-    switch (root->type) {
-        case GROUP:
-            this->drawGroup(static_cast<AminoGroup *>(root));
-            break;
+    //history (newest first)
+    memmove(damageHistory[1], damageHistory[0], (DAMAGE_HISTORY_SIZE - 1) * sizeof(damageHistory[0]));
+    memcpy(damageHistory[0], frameDamage, sizeof(damageHistory[0]));
+
+    if (damageHistoryCount < DAMAGE_HISTORY_SIZE) {
+        damageHistoryCount++;
+    }
+
+    //unknown buffer content
+    if (bufferAge <= 0 || bufferAge > damageHistoryCount) {
+        return false;
+    }
+
+    //changes since the buffer was rendered
+    GLfloat damage[4];
+
+    clear_bounds(damage);
+
+    for (int i = 0; i < bufferAge; i++) {
+        union_bounds(damage, damageHistory[i]);
+    }
+
+    intersect_bounds(damage, viewport);
+
+    if (is_empty_bounds(damage)) {
+        //nothing changed
+        rect[0] = rect[1] = rect[2] = rect[3] = 0;
+    } else {
+        GLint x1 = (GLint)floorf(damage[0]);
+        GLint y1 = (GLint)floorf(damage[1]);
+        GLint x2 = (GLint)ceilf(damage[2]);
+        GLint y2 = (GLint)ceilf(damage[3]);
+
+        //full redraw threshold
+        if ((GLfloat)(x2 - x1) * (y2 - y1) > threshold * viewport[2] * viewport[3]) {
+            return false;
+        }
+
+        rect[0] = x1;
+        rect[1] = y1;
+        rect[2] = x2 - x1;
+        rect[3] = y2 - y1;
+    }
+
+    memcpy(damageRect, rect, sizeof(damageRect));
+    damagePartial = true;
+
+    return true;
+}
+
+/**
+ * Redraw everything in the next frame.
+ */
+void AminoRenderer::invalidateDamage() {
+    damageAll = true;
+}
 
+/**
+ * Record all commands again before the next frame (e.g. new root node).
+ */
+void AminoRenderer::invalidateCommands() {
+    recordAll = true;
+}
+
+/**
+ * Update the screen bounds of all nodes and collect the changed regions.
+ */
+void AminoRenderer::updateBounds() {
+    std::size_t i = 0;
+
+    groupStack.clear();
+    boundsStack.clear();
+
+    while (i < commands.size()) {
+        draw_command_t *cmd = &commands[i];
+        AminoNode *node = cmd->node;
+
+        //end of group
+        if (cmd->type == COMMAND_GROUP_END) {
+            AminoGroup *group = static_cast<AminoGroup *>(node);
+            std::size_t offset = boundsStack.size() - 4;
+            GLfloat bounds[4];
+
+            memcpy(bounds, &boundsStack[offset], sizeof(bounds));
+            boundsStack.resize(offset);
+
+            //clipped children
+            if (group->propClipRect->value) {
+                GLfloat local[4] = { 0, 0, group->propW->value, group->propH->value };
+                GLfloat clip[4];
+
+                projectBounds(group->worldMatrix, local, clip);
+                intersect_bounds(bounds, clip);
+            }
+
+            //Note: children track their own changes
+            updateNodeDamage(group, bounds, group->damaged);
+
+            groupStack.pop_back();
+            i++;
+            continue;
+        }
+
+        //children changed
+        if (cmd->type == GROUP && cmd->version != static_cast<AminoGroup *>(node)->childrenVersion) {
+            recordGroup(i);
+            cmd = &commands[i];
+            node->damaged = true;
+        }
+
+        //hidden nodes (including children)
+        if (!node->propVisible->value) {
+            if (node->screenBoundsValid) {
+                addDamage(node->screenBounds);
+                node->screenBoundsValid = false;
+            }
+
+            node->damaged = false;
+            i += cmd->size;
+            continue;
+        }
+
+        node->updateWorldMatrix(cmd->parent);
+
+        //group: bounds of all children
+        if (cmd->type == GROUP) {
+            std::size_t offset = boundsStack.size();
+
+            boundsStack.resize(offset + 4);
+            clear_bounds(&boundsStack[offset]);
+
+            groupStack.push_back(i);
+            i++;
+            continue;
+        }
+
+        //node bounds (cached until transformation, view or properties change)
+        GLfloat bounds[4];
+
+        if (node->damaged || !node->screenBoundsValid || node->screenBoundsMatrix != node->worldMatrixVersion || node->screenBoundsView != viewVersion) {
+            GLfloat local[4];
+
+            if (node->getLocalBounds(local)) {
+                projectBounds(node->worldMatrix, local, bounds);
+            } else {
+                //unknown (e.g. polygons)
+                bounds[0] = 0;
+                bounds[1] = 0;
+                bounds[2] = viewportSize[0];
+                bounds[3] = viewportSize[1];
+            }
+
+            node->screenBoundsMatrix = node->worldMatrixVersion;
+            node->screenBoundsView = viewVersion;
+        } else {
+            memcpy(bounds, node->screenBounds, sizeof(bounds));
+        }
+
+        bool changed = node->damaged || node->contentChanged() || !node->screenBoundsValid || memcmp(bounds, node->screenBounds, sizeof(bounds)) != 0;
+
+        updateNodeDamage(node, bounds, changed);
+        i++;
+    }
+
+    assert(groupStack.empty());
+
+    boundsUpdated = true;
+}
+
+/**
+ * Store the new screen bounds of a node.
+ */
+void AminoRenderer::updateNodeDamage(AminoNode *node, GLfloat *bounds, bool changed) {
+    if (changed) {
+        if (node->screenBoundsValid) {
+            addDamage(node->screenBounds);
+        }
+
+        addDamage(bounds);
+    }
+
+    memcpy(node->screenBounds, bounds, 4 * sizeof(GLfloat));
+    node->screenBoundsValid = true;
+    node->damaged = false;
+
+    //parent group
+    if (!boundsStack.empty()) {
+        union_bounds(&boundsStack[boundsStack.size() - 4], bounds);
+    }
+}
+
+/**
+ * Add a damaged region.
+ */
+void AminoRenderer::addDamage(GLfloat *bounds) {
+    union_bounds(frameDamage, bounds);
+}
+
+/**
+ * Get the window coordinates of local bounds.
+ *
+ * Returns false if the bounds could not be projected (the whole viewport is used).
+ */
+bool AminoRenderer::projectBounds(GLfloat *matrix, GLfloat *local, GLfloat *bounds) {
+    if (is_empty_bounds(local)) {
+        clear_bounds(bounds);
+        return true;
+    }
+
+    GLfloat m[16];
+
+    mul_matrix(m, modelView, matrix);
+
+    GLfloat corners[4][2] = {
+        { local[0], local[1] },
+        { local[2], local[1] },
+        { local[0], local[3] },
+        { local[2], local[3] }
+    };
+
+    for (int i = 0; i < 4; i++) {
+        GLfloat x = corners[i][0];
+        GLfloat y = corners[i][1];
+        GLfloat w = m[3] * x + m[7] * y + m[15];
+
+        if (w <= 0.0001f) {
+            //behind the eye
+            bounds[0] = 0;
+            bounds[1] = 0;
+            bounds[2] = viewportSize[0];
+            bounds[3] = viewportSize[1];
+
+            return false;
+        }
+
+        //normalized device coordinates to window coordinates
+        GLfloat winX = ((m[0] * x + m[4] * y + m[12]) / w + 1) * .5f * viewportSize[0];
+        GLfloat winY = ((m[1] * x + m[5] * y + m[13]) / w + 1) * .5f * viewportSize[1];
+
+        if (i == 0) {
+            bounds[0] = bounds[2] = winX;
+            bounds[1] = bounds[3] = winY;
+        } else {
+            bounds[0] = fminf(bounds[0], winX);
+            bounds[1] = fminf(bounds[1], winY);
+            bounds[2] = fmaxf(bounds[2], winX);
+            bounds[3] = fmaxf(bounds[3], winY);
+        }
+    }
+
+    //antialiasing
+    bounds[0] -= 1;
+    bounds[1] -= 1;
+    bounds[2] += 1;
+    bounds[3] += 1;
+
+    return true;
+}
+
+/**
+ * Record the draw commands of a node and its children.
+ */
+void AminoRenderer::recordNode(AminoNode *node, AminoNode *parent, std::vector<draw_command_t> &list) {
+    std::size_t index = list.size();
+    draw_command_t cmd = { node, parent, node->type, 1, 0 };
+
+    list.push_back(cmd);
+
+    if (node->type == GROUP) {
+        AminoGroup *group = static_cast<AminoGroup *>(node);
+        std::size_t count = group->children.size();
+
+        list[index].version = group->childrenVersion;
+
+        for (std::size_t i = 0; i < count; i++) {
+            recordNode(group->children[i], group, list);
+        }
+
+        //end of group
+        draw_command_t end = { node, parent, COMMAND_GROUP_END, 1, 0 };
+
+        list.push_back(end);
+        list[index].size = list.size() - index;
+    }
+}
+
+/**
+ * Record the commands of a group again (children changed).
+ *
+ * Note: the parent groups have to be on the group stack.
+ */
+void AminoRenderer::recordGroup(std::size_t index) {
+    draw_command_t *cmd = &commands[index];
+    std::size_t oldSize = cmd->size;
+
+    if (DEBUG_RENDERER) {
+        printf("-> recordGroup()\n");
+    }
+
+    recordBuffer.clear();
+    recordNode(cmd->node, cmd->parent, recordBuffer);
+
+    std::size_t newSize = recordBuffer.size();
+
+    //replace range
+    if (newSize > oldSize) {
+        commands.insert(commands.begin() + index + oldSize, newSize - oldSize, recordBuffer[0]);
+    } else if (newSize < oldSize) {
+        commands.erase(commands.begin() + index + newSize, commands.begin() + index + oldSize);
+    }
+
+    std::copy(recordBuffer.begin(), recordBuffer.end(), commands.begin() + index);
+
+    //update parent groups
+    std::size_t count = groupStack.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        commands[groupStack[i]].size = commands[groupStack[i]].size + newSize - oldSize;
+    }
+}
+
+/**
+ * Replay the recorded commands.
+ */
+void AminoRenderer::renderCommands() {
+    std::size_t i = 0;
+
+    groupStack.clear();
+
+    //visible region
+    cullStack.resize(4);
+    cullStack[0] = 0;
+    cullStack[1] = 0;
+    cullStack[2] = viewportSize[0];
+    cullStack[3] = viewportSize[1];
+
+    if (damagePartial) {
+        GLfloat damage[4] = { (GLfloat)damageRect[0], (GLfloat)damageRect[1], (GLfloat)(damageRect[0] + damageRect[2]), (GLfloat)(damageRect[1] + damageRect[3]) };
+
+        intersect_bounds(&cullStack[0], damage);
+    }
+
+    culledNodes = 0;
+    culledGroups = 0;
+
+    while (i < commands.size()) {
+        draw_command_t *cmd = &commands[i];
+
+        //end of group
+        if (cmd->type == COMMAND_GROUP_END) {
+            endGroup(static_cast<AminoGroup *>(cmd->node));
+            ctx->restore();
+
+            groupStack.pop_back();
+            cullStack.resize(cullStack.size() - 4);
+            i++;
+            continue;
+        }
+
+        AminoNode *node = cmd->node;
+
+        //children changed
+        if (cmd->type == GROUP && cmd->version != static_cast<AminoGroup *>(node)->childrenVersion) {
+            recordGroup(i);
+            cmd = &commands[i];
+        }
+
+        //skip non-visible nodes (including children)
+        if (!node->propVisible->value) {
+            i += cmd->size;
+            continue;
+        }
+
+        //skip nodes outside of the visible region (including children)
+        if (culling && node->screenBoundsValid && !overlaps_bounds(node->screenBounds, &cullStack[cullStack.size() - 4])) {
+            if (cmd->type == GROUP) {
+                culledGroups++;
+            } else {
+                culledNodes++;
+            }
+
+            i += cmd->size;
+            continue;
+        }
+
+        //transform (cached)
+        node->updateWorldMatrix(cmd->parent);
+
+        ctx->save(node->worldMatrix);
+
+        //group: restored at end of group
+        if (cmd->type == GROUP) {
+            AminoGroup *group = static_cast<AminoGroup *>(node);
+
+            beginGroup(group);
+
+            groupStack.push_back(i);
+
+            //visible region of children
+            std::size_t offset = cullStack.size();
+
+            cullStack.resize(offset + 4);
+            memcpy(&cullStack[offset], &cullStack[offset - 4], 4 * sizeof(GLfloat));
+
+            if (group->propClipRect->value) {
+                GLfloat local[4] = { 0, 0, group->propW->value, group->propH->value };
+                GLfloat clip[4];
+
+                projectBounds(group->worldMatrix, local, clip);
+                intersect_bounds(&cullStack[offset], clip);
+            }
+
+            i++;
+            continue;
+        }
+
+        //draw
+        render(node);
+
+        ctx->restore();
+        i++;
+    }
+
+    assert(groupStack.empty());
+}
+
+/**
+ * Get rendering statistics (last frame).
+ */
+void AminoRenderer::getStats(v8::Local<v8::Object> &obj) {
+    Nan::Set(obj, Nan::New("culledNodes").ToLocalChecked(), Nan::New(culledNodes));
+    Nan::Set(obj, Nan::New("culledGroups").ToLocalChecked(), Nan::New(culledGroups));
+}
+
+/**
+ * Render a node (without children).
+ */
+void AminoRenderer::render(AminoNode *node) {
+    if (DEBUG_RENDERER) {
+        printf("-> render()\n");
+    }
+
+    //draw
+    switch (node->type) {
         case RECT:
-            this->drawRect(static_cast<AminoRect *>(root));
+            this->drawRect(static_cast<AminoRect *>(node));
             break;
 
         case POLY:
-            this->drawPoly(static_cast<AminoPolygon *>(root));
+            this->drawPoly(static_cast<AminoPolygon *>(node));
             break;
 
         case MODEL:
-            this->drawModel(static_cast<AminoModel *>(root));
+            this->drawModel(static_cast<AminoModel *>(node));
             break;
 
         case TEXT:
-            this->drawText(static_cast<AminoText *>(root));
+            this->drawText(static_cast<AminoText *>(node));
             break;
 
         default:
-            printf("invalid node type: %i\n", root->type);
+            printf("invalid node type: %i\n", node->type);
             break;
     }
 
@@ -410,9 +1036,6 @@ void AminoRenderer::render(AminoNode *root) {
     if (DEBUG_RENDERER_ERRORS) {
         showGLErrors();
     }
-
-    //done
-    ctx->restore();
 }
 
 /**
@@ -444,71 +1067,152 @@ void AminoRenderer::applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count,
         colorShader->drawTriangles(count, mode);
     }
 
-    //cleanup
-    if (hasAlpha) {
-        glDisable(GL_BLEND);
+    //cleanup
+    if (hasAlpha) {
+        glDisable(GL_BLEND);
+    }
+}
+
+/**
+ * Create the static unit quad buffers.
+ */
+void AminoRenderer::initQuadBuffer() {
+    //two triangles (0..1)
+    GLfloat verts[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    GLushort indices[6] = { 0, 1, 2, 2, 3, 0 };
+
+    glGenBuffers(1, &quadBuffer);
+    glGenBuffers(1, &quadIndexBuffer);
+
+    assert(quadBuffer != INVALID_BUFFER);
+    assert(quadIndexBuffer != INVALID_BUFFER);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof verts, verts, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof indices, indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    //vertex array objects (OpenGL ES 2.0 extension)
+#if defined RPI && defined GL_OES_vertex_array_object
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+
+    if (extensions && strstr(extensions, "GL_OES_vertex_array_object")) {
+        genVertexArrays = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
+        bindVertexArray = (PFNGLBINDVERTEXARRAYOESPROC)eglGetProcAddress("glBindVertexArrayOES");
+        deleteVertexArrays = (PFNGLDELETEVERTEXARRAYSOESPROC)eglGetProcAddress("glDeleteVertexArraysOES");
+
+        vaoSupported = genVertexArrays && bindVertexArray && deleteVertexArrays;
+    }
+#endif
+
+    if (DEBUG_RENDERER) {
+        printf("-> unit quad: vao=%s\n", vaoSupported ? "true":"false");
     }
 }
 
 /**
- * Draw texture.
+ * Bind the unit quad buffers.
+ *
+ * Returns true if the vertex attributes have to be set by the shader.
  */
-void AminoRenderer::applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat uv[][2], GLuint texId, GLfloat opacity, bool needsClampToBorder, bool repeatX, bool repeatY) {
-    //printf("doing texture shader apply %d opacity = %f\n", texId, opacity);
+bool AminoRenderer::bindQuadBuffer(GLuint &vao) {
+#if defined RPI && defined GL_OES_vertex_array_object
+    if (vaoSupported) {
+        if (vao != INVALID_BUFFER) {
+            //attributes and index buffer stored in VAO
+            bindVertexArray(vao);
+
+            return false;
+        }
 
-    //use shader
-    TextureShader *shader;
+        //first use: record the state
+        genVertexArrays(1, &vao);
+        bindVertexArray(vao);
+    }
+#endif
 
-    if (needsClampToBorder) {
-        if (!textureClampToBorderShader) {
-            textureClampToBorderShader = new TextureClampToBorderShader();
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
 
-            bool res = textureClampToBorderShader->create();
+    return true;
+}
 
-            assert(res);
-        }
+/**
+ * Unbind the unit quad buffers.
+ */
+void AminoRenderer::unbindQuadBuffer() {
+#if defined RPI && defined GL_OES_vertex_array_object
+    if (vaoSupported) {
+        //Note: the element array binding is part of the VAO
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        shader = textureClampToBorderShader;
+        return;
+    }
+#endif
 
-        //debug
-        //printf("using clamp to border shader\n");
-    } else {
-        shader = textureShader;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/**
+ * Draw texture (unit quad with clamp to border).
+ */
+void AminoRenderer::drawTextureQuad(GLfloat w, GLfloat h, GLfloat uv[4], GLuint texId, GLfloat opacity, bool repeatX, bool repeatY) {
+    //use shader
+    if (!quadTextureShader) {
+        quadTextureShader = new QuadTextureShader();
+
+        bool res = quadTextureShader->create();
+
+        assert(res);
     }
 
-    ctx->useShader(shader);
+    ctx->useShader(quadTextureShader);
 
     //blend
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     //shader values
-    shader->setTransformation(modelView, ctx->globaltx);
-    shader->setOpacity(opacity);
-
-    if (needsClampToBorder) {
-        (static_cast<TextureClampToBorderShader *>(shader))->setRepeat(repeatX, repeatY);
-    }
+    quadTextureShader->setTransformation(modelView, ctx->globaltx);
+    quadTextureShader->setOpacity(opacity);
+    quadTextureShader->setRepeat(repeatX, repeatY);
+    quadTextureShader->setSize(w, h);
+    quadTextureShader->setTextureRect(uv);
 
     //draw
     ctx->bindTexture(texId);
-    shader->setVertexData(dim, verts);
-    shader->setTextureCoordinates(uv);
-    shader->drawTriangles(count, GL_TRIANGLES);
+
+    if (bindQuadBuffer(quadTextureVao)) {
+        quadTextureShader->setVertexBuffer();
+    }
+
+    quadTextureShader->drawElements(NULL, 6, GL_TRIANGLES);
+    unbindQuadBuffer();
 
     //cleanup
     glDisable(GL_BLEND);
 }
 
 /**
- * Draw group.
+ * Start drawing a group.
  */
-void AminoRenderer::drawGroup(AminoGroup *group) {
+void AminoRenderer::beginGroup(AminoGroup *group) {
     if (DEBUG_RENDERER) {
-        printf("-> drawGroup()\n");
+        printf("-> beginGroup()\n");
     }
 
     bool useDepth = group->propDepth->value;
+    bool useClipping = group->propClipRect->value;
+
+    if (useDepth || useClipping) {
+        //GL state changes
+        flushBatch();
+    }
 
     if (useDepth) {
         //enable depth mask
@@ -518,72 +1222,194 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     /*
      * Clipping:
      *
-     *  - quite slow on Raspberry Pi!
+     *  - scissor test if the clip rect is axis-aligned on screen
+     *  - stencil buffer otherwise (quite slow on Raspberry Pi!)
      */
-    bool useClipping = group->propClipRect->value;
-
     if (useClipping) {
-        //turn on stenciling
-        glEnable(GL_STENCIL_TEST);
+        GLfloat w = group->propW->value;
+        GLfloat h = group->propH->value;
+        clip_state_t state = { scissorTest, { scissor[0], scissor[1], scissor[2], scissor[3] }, stencilRef, false };
+        GLint rect[4];
+
+        clipStack.push_back(state);
+
+        if (getScissorRect(w, h, rect)) {
+            //intersect with parent
+            if (scissorTest) {
+                GLint x1 = std::max(rect[0], scissor[0]);
+                GLint y1 = std::max(rect[1], scissor[1]);
+                GLint x2 = std::min(rect[0] + rect[2], scissor[0] + scissor[2]);
+                GLint y2 = std::min(rect[1] + rect[3], scissor[1] + scissor[3]);
+
+                rect[0] = x1;
+                rect[1] = y1;
+                rect[2] = std::max(x2 - x1, 0);
+                rect[3] = std::max(y2 - y1, 0);
+            }
+
+            memcpy(scissor, rect, sizeof(scissor));
 
-        //setup the stencil
-        glStencilFunc(GL_ALWAYS, 0x1, 0xFF);
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-        glStencilMask(0xFF);
-        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            if (!scissorTest) {
+                glEnable(GL_SCISSOR_TEST);
+                scissorTest = true;
+            }
 
-        //clear the buffers
-        glClear(GL_STENCIL_BUFFER_BIT);
+            glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+        } else {
+            clipStack.back().usesStencil = true;
 
-        //draw the stencil
-        float x = 0;
-        float y = 0;
-        float x2 = group->propW->value;
-        float y2 = group->propH->value;
-        GLfloat verts[6][2];
+            if (stencilRef == 0) {
+                //top level: new value (no clear needed)
+                if (stencilCounter >= 0xF0) {
+                    //keep space for nested values
+                    glStencilMask(0xFF);
+                    glClear(GL_STENCIL_BUFFER_BIT);
+                    stencilCounter = 0;
+                }
 
-        verts[0][0] = x;
-        verts[0][1] = y;
-        verts[1][0] = x2;
-        verts[1][1] = y;
-        verts[2][0] = x2;
-        verts[2][1] = y2;
+                stencilCounter++;
 
-        verts[3][0] = x2;
-        verts[3][1] = y2;
-        verts[4][0] = x;
-        verts[4][1] = y2;
-        verts[5][0] = x;
-        verts[5][1] = y;
+                glEnable(GL_STENCIL_TEST);
+                glStencilFunc(GL_ALWAYS, stencilCounter, 0xFF);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-        GLfloat color[4] = { 1.0, 1.0, 1.0, 1.0 };
+                stencilRef = stencilCounter;
+            } else {
+                //nested: increment inside the parent region
+                glStencilFunc(GL_EQUAL, stencilRef, 0xFF);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
 
-        applyColorShader((float *)verts, 2, 6, color);
+                stencilRef++;
+            }
 
-        //set function to draw pixels where the buffer is equal to 1
-        glStencilFunc(GL_EQUAL, 0x1, 0xFF);
-        glStencilMask(0x00);
+            drawStencilQuad(w, h);
 
-        //turn color buffer drawing back on
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            //draw pixels inside the clip region
+            glStencilFunc(GL_EQUAL, stencilRef, 0xFF);
+        }
     }
 
     //group opacity
     ctx->saveOpacity();
     ctx->applyOpacity(group->propOpacity->value);
+}
 
-    //render items
-    std::size_t count = group->children.size();
+/**
+ * Get the window coordinates of a clip rect (x, y, w, h).
+ *
+ * Returns false if the rect is rotated or uses a perspective transformation.
+ */
+bool AminoRenderer::getScissorRect(GLfloat w, GLfloat h, GLint *rect) {
+    GLfloat m[16];
 
-    for (std::size_t i = 0; i < count; i++) {
-        this->render(group->children[i]);
+    mul_matrix(m, modelView, ctx->globaltx);
+
+    //axis-aligned
+    if (fabsf(m[1]) > 1e-7f || fabsf(m[4]) > 1e-7f || fabsf(m[3]) > 1e-7f || fabsf(m[7]) > 1e-7f || m[15] <= 0) {
+        return false;
+    }
+
+    //window coordinates
+    GLfloat x1 = (m[12] / m[15] + 1) * .5f * viewportSize[0];
+    GLfloat y1 = (m[13] / m[15] + 1) * .5f * viewportSize[1];
+    GLfloat x2 = ((m[0] * w + m[12]) / m[15] + 1) * .5f * viewportSize[0];
+    GLfloat y2 = ((m[5] * h + m[13]) / m[15] + 1) * .5f * viewportSize[1];
+
+    //round to pixel centers
+    GLint left = (GLint)floorf(fminf(x1, x2) + .5f);
+    GLint bottom = (GLint)floorf(fminf(y1, y2) + .5f);
+    GLint right = (GLint)floorf(fmaxf(x1, x2) + .5f);
+    GLint top = (GLint)floorf(fmaxf(y1, y2) + .5f);
+
+    rect[0] = left;
+    rect[1] = bottom;
+    rect[2] = right - left;
+    rect[3] = top - bottom;
+
+    return true;
+}
+
+/**
+ * Draw the clip rect to the stencil buffer.
+ */
+void AminoRenderer::drawStencilQuad(GLfloat w, GLfloat h) {
+    glStencilMask(0xFF);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    GLfloat color[4] = { 1.0, 1.0, 1.0, 1.0 };
+
+    //unit quad
+    ctx->useShader(quadShader);
+
+    quadShader->setTransformation(modelView, ctx->globaltx);
+    quadShader->setColor(color);
+    quadShader->setSize(w, h);
+
+    if (bindQuadBuffer(quadVao)) {
+        quadShader->setVertexBuffer();
+    }
+
+    quadShader->drawElements(NULL, 6, GL_TRIANGLES);
+    unbindQuadBuffer();
+
+    //turn color buffer drawing back on
+    glStencilMask(0x00);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+/**
+ * Done drawing a group.
+ */
+void AminoRenderer::endGroup(AminoGroup *group) {
+    if (DEBUG_RENDERER) {
+        printf("-> endGroup()\n");
     }
 
+    bool useDepth = group->propDepth->value;
+    bool useClipping = group->propClipRect->value;
+
     //restore opacity
     ctx->restoreOpacity();
 
+    if (useDepth || useClipping) {
+        //draw clipped quads
+        flushBatch();
+    }
+
     if (useClipping) {
-        glDisable(GL_STENCIL_TEST);
+        assert(!clipStack.empty());
+
+        clip_state_t *state = &clipStack.back();
+
+        //stencil
+        if (state->usesStencil) {
+            if (state->stencilRef == 0) {
+                glDisable(GL_STENCIL_TEST);
+            } else {
+                //nested: restore the parent region
+                glStencilFunc(GL_EQUAL, stencilRef, 0xFF);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+
+                drawStencilQuad(group->propW->value, group->propH->value);
+
+                glStencilFunc(GL_EQUAL, state->stencilRef, 0xFF);
+            }
+
+            stencilRef = state->stencilRef;
+        }
+
+        //scissor
+        if (state->scissorTest) {
+            if (memcmp(scissor, state->scissor, sizeof(scissor)) != 0) {
+                memcpy(scissor, state->scissor, sizeof(scissor));
+                glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+            }
+        } else if (scissorTest) {
+            glDisable(GL_SCISSOR_TEST);
+        }
+
+        scissorTest = state->scissorTest;
+        clipStack.pop_back();
     }
 
     if (useDepth) {
@@ -600,11 +1426,12 @@ void AminoRenderer::drawPoly(AminoPolygon *poly) {
         printf("-> drawPoly()\n");
     }
 
+    flushBatch();
+
     //vertices
-    std::vector<float> *geometry = &poly->propGeometry->value;
-    int len = geometry->size();
+    int len = poly->propGeometry->getSize();
     int dim = poly->propDimension->value;
-    GLfloat *verts = geometry->data();
+    GLfloat *verts = poly->propGeometry->getData();
 
     assert(dim == 2 || dim == 3);
 
@@ -629,12 +1456,12 @@ void AminoRenderer::drawPoly(AminoPolygon *poly) {
  * Draw 3D model.
  */
 void AminoRenderer::drawModel(AminoModel *model) {
+    flushBatch();
+
     //check rendering mode
 
     // 1) vertices
-    std::vector<float> *vecVertices = &model->propVertices->value;
-
-    if (vecVertices->empty()) {
+    if (model->propVertices->isEmpty()) {
         return;
     }
 
@@ -657,12 +1484,10 @@ void AminoRenderer::drawModel(AminoModel *model) {
     }
 
     // 3) normals (optional)
-    std::vector<float> *vecNormals = &model->propNormals->value;
-    bool useNormals = !vecNormals->empty();
+    bool useNormals = !model->propNormals->isEmpty();
 
     // 4) texture coordinates (optional)
-    std::vector<float> *vecUVs = &model->propUVs->value;
-    bool useUVs = !vecUVs->empty();
+    bool useUVs = !model->propUVs->isEmpty();
 
     if (useUVs && !model->propTexture->value) {
         //texture not yet loaded
@@ -679,7 +1504,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
         //use lighting shader
 
         if (!useElements) {
-            assert(vecNormals->size() == vecVertices->size());
+            assert(model->propNormals->getSize() == model->propVertices->getSize());
         }
 
         //get normals
@@ -692,7 +1517,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
 
         if (model->vboNormalModified) {
             model->vboNormalModified = false;
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecNormals->size(), vecNormals->data(), GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * model->propNormals->getSize(), model->propNormals->getData(), GL_STATIC_DRAW);
         }
 
         //get shader
@@ -768,7 +1593,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
 
         if (model->vboUVModified) {
             model->vboUVModified = false;
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecUVs->size(), vecUVs->data(), GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * model->propUVs->getSize(), model->propUVs->getData(), GL_STATIC_DRAW);
         }
 
         textureShader->setTextureCoordinates(NULL);
@@ -802,7 +1627,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
 
     if (model->vboVertexModified) {
         model->vboVertexModified = false;
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vecVertices->size(), vecVertices->data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * model->propVertices->getSize(), model->propVertices->getData(), GL_STATIC_DRAW);
     }
 
     shader->setVertexData(3, NULL);
@@ -821,7 +1646,7 @@ void AminoRenderer::drawModel(AminoModel *model) {
         shader->drawElements(NULL, vecIndices->size(), GL_TRIANGLES);
     } else {
         //render vertices (array or VBO)
-        shader->drawTriangles(vecVertices->size() / 3, GL_TRIANGLES);
+        shader->drawTriangles(model->propVertices->getSize() / 3, GL_TRIANGLES);
     }
 
     //cleanup
@@ -848,30 +1673,8 @@ void AminoRenderer::drawRect(AminoRect *rect) {
         printf("-> drawRect() hasImage=%s\n", rect->hasImage ? "true":"false");
     }
 
-    ctx->save();
-
-    //two triangles
-    float x =  0;
-    float y =  0;
-    float x2 = rect->propW->value;
-    float y2 = rect->propH->value;
-
-    GLfloat verts[6][2];
-
-    verts[0][0] = x;
-    verts[0][1] = y;
-    verts[1][0] = x2;
-    verts[1][1] = y;
-    verts[2][0] = x2;
-    verts[2][1] = y2;
-
-    verts[3][0] = x2;
-    verts[3][1] = y2;
-    verts[4][0] = x;
-    verts[4][1] = y2;
-    verts[5][0] = x;
-    verts[5][1] = y;
-
+    GLfloat w = rect->propW->value;
+    GLfloat h = rect->propH->value;
     GLfloat opacity = rect->propOpacity->value * ctx->opacity;
 
     if (rect->hasImage) {
@@ -885,20 +1688,11 @@ void AminoRenderer::drawRect(AminoRect *rect) {
             //printf("texture: %i\n", texture->textureId);
 
             //image coordinates (fractional world coordinates)
-            GLfloat texCoords[6][2];
             float tx  = rect->propLeft->value;   //0
             float ty2 = rect->propBottom->value; //1
             float tx2 = rect->propRight->value;  //1
             float ty  = rect->propTop->value;    //0
 
-            texCoords[0][0] = tx;    texCoords[0][1] = ty;
-            texCoords[1][0] = tx2;   texCoords[1][1] = ty;
-            texCoords[2][0] = tx2;   texCoords[2][1] = ty2;
-
-            texCoords[3][0] = tx2;   texCoords[3][1] = ty2;
-            texCoords[4][0] = tx;    texCoords[4][1] = ty2;
-            texCoords[5][0] = tx;    texCoords[5][1] = ty;
-
             //check clamp to border
             bool needsClampToBorder = (tx < 0 || tx > 1) || (tx2 < 0 || tx2 > 1) || (ty < 0 || ty > 1) || (ty2 < 0 || ty2 > 1) || rect->repeatX || rect->repeatY;
 
@@ -906,106 +1700,244 @@ void AminoRenderer::drawRect(AminoRect *rect) {
             //if (needsClampToBorder) printf("needsClampToBorder\n");
 
             texture->prepareTexture(ctx);
-            applyTextureShader((float *)verts, 2, 6, texCoords, texture->getTexture(), opacity, needsClampToBorder, rect->repeatX, rect->repeatY);
+
+            if (needsClampToBorder) {
+                //not batched (uses repeat uniforms)
+                flushBatch();
+
+                GLfloat uv[4] = { tx, ty, tx2, ty2 };
+
+                drawTextureQuad(w, h, uv, texture->getTexture(), opacity, rect->repeatX, rect->repeatY);
+            } else {
+                //batched texture
+                GLfloat color[4] = { 1.0, 1.0, 1.0, opacity };
+                GLfloat uv[4] = { tx, ty, tx2, ty2 };
+
+                batchQuad(batchTextureShader, texture->getTexture(), true, w, h, color, uv);
+            }
         }
     } else {
-        //color only
+        //color only (batched)
         GLfloat color[4] = { rect->propR->value, rect->propG->value, rect->propB->value, opacity };
 
-        applyColorShader((float *)verts, 2, 6, color);
+        batchQuad(batchShader, INVALID_TEXTURE, opacity != 1.0, w, h, color, NULL);
     }
+}
 
-    ctx->restore();
+/**
+ * Add a quad to the batch.
+ *
+ * Note: the batch is flushed if shader, texture or blend state change.
+ */
+void AminoRenderer::batchQuad(BatchShader *shader, GLuint texId, bool blend, GLfloat w, GLfloat h, GLfloat color[4], GLfloat uv[4]) {
+    //check state
+    if (shader != batchActiveShader || texId != batchTexture || blend != batchBlend) {
+        flushBatch();
+
+        batchActiveShader = shader;
+        batchTexture = texId;
+        batchBlend = blend;
+    }
+
+    //corners (top-left, top-right, bottom-right, bottom-left)
+    GLfloat xs[4] = { 0, w, w, 0 };
+    GLfloat ys[4] = { 0, 0, h, h };
+    GLfloat *m = ctx->globaltx;
+    batch_vertex_t corners[4];
+
+    for (int i = 0; i < 4; i++) {
+        batch_vertex_t *v = &corners[i];
+        GLfloat x = xs[i];
+        GLfloat y = ys[i];
+
+        //pre-transform (z = 0)
+        v->pos[0] = m[0] * x + m[4] * y + m[12];
+        v->pos[1] = m[1] * x + m[5] * y + m[13];
+        v->pos[2] = m[2] * x + m[6] * y + m[14];
+        v->pos[3] = m[3] * x + m[7] * y + m[15];
+
+        v->color[0] = color[0];
+        v->color[1] = color[1];
+        v->color[2] = color[2];
+        v->color[3] = color[3];
+    }
+
+    //texture coordinates (left, top, right, bottom)
+    if (uv) {
+        corners[0].uv[0] = uv[0]; corners[0].uv[1] = uv[1];
+        corners[1].uv[0] = uv[2]; corners[1].uv[1] = uv[1];
+        corners[2].uv[0] = uv[2]; corners[2].uv[1] = uv[3];
+        corners[3].uv[0] = uv[0]; corners[3].uv[1] = uv[3];
+    } else {
+        for (int i = 0; i < 4; i++) {
+            corners[i].uv[0] = 0;
+            corners[i].uv[1] = 0;
+        }
+    }
+
+    //two triangles
+    batchVertices.push_back(corners[0]);
+    batchVertices.push_back(corners[1]);
+    batchVertices.push_back(corners[2]);
+
+    batchVertices.push_back(corners[2]);
+    batchVertices.push_back(corners[3]);
+    batchVertices.push_back(corners[0]);
 }
 
 /**
- * Render text.
+ * Draw all batched quads.
  */
-void AminoRenderer::drawText(AminoText *text) {
+void AminoRenderer::flushBatch() {
+    std::size_t count = batchVertices.size();
+
+    if (count == 0) {
+        return;
+    }
+
+    assert(batchActiveShader);
+
     if (DEBUG_RENDERER) {
-        printf("-> drawText()\n");
+        printf("-> flushBatch() quads=%i\n", (int)(count / 6));
     }
 
-    //get texture
-    GLuint texture = text->getTextureId();
+    //use shader
+    ctx->useShader(batchActiveShader);
+    batchActiveShader->setModelView(modelView);
 
-    if (texture == INVALID_TEXTURE) {
-        return;
+    //blend
+    if (batchBlend) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
 
-    ctx->save();
+    //texture
+    if (batchTexture != INVALID_TEXTURE) {
+        //Note: video players bind their texture directly while preparing it
+        ctx->prevTex = INVALID_TEXTURE;
+        ctx->bindTexture(batchTexture);
+    }
 
-    //flip the y axis
-    ctx->scale(1, -1);
+    //upload vertices (streaming)
+    glBindBuffer(GL_ARRAY_BUFFER, batchBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(batch_vertex_t) * count, batchVertices.data(), GL_STREAM_DRAW);
 
-    //baseline at top/left
-    texture_font_t *tf = text->fontSize->fontTexture;
+    //draw
+    batchActiveShader->setVertexBuffer();
+    batchActiveShader->drawTriangles(count, GL_TRIANGLES);
 
-    //debug
-    //sprintf("font: size=%f height=%f ascender=%f descender=%f\n", tf->size, tf->height, tf->ascender, tf->descender);
+    //cleanup
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    //horizontal alignment
-    switch (text->align) {
-        case AminoText::ALIGN_CENTER:
-            ctx->translate((text->propW->value - text->lineW) / 2, 0);
-            break;
+    if (batchBlend) {
+        glDisable(GL_BLEND);
+    }
 
-        case AminoText::ALIGN_RIGHT:
-            ctx->translate(text->propW->value - text->lineW, 0);
-            break;
+    batchVertices.clear();
+}
 
-        case AminoText::ALIGN_LEFT:
-        default:
-            break;
+/**
+ * Render text.
+ */
+void AminoRenderer::drawText(AminoText *text) {
+    if (DEBUG_RENDERER) {
+        printf("-> drawText()\n");
     }
 
-    //vertical alignment
-    switch (text->vAlign) {
-        case AminoText::VALIGN_TOP:
-            ctx->translate(0, -tf->ascender);
-            break;
+    //check atlas pages
+    if (text->pages.empty()) {
+        return;
+    }
 
-        case AminoText::VALIGN_BOTTOM:
-            ctx->translate(0, - text->propH->value - tf->descender + (text->lineNr - 1) * tf->height);
-            break;
+    if (!text->touchAtlasPages()) {
+        //page was evicted
+        gfx->relayoutText(text);
 
-        case AminoText::VALIGN_MIDDLE:
-            ctx->translate(0, - tf->ascender - (text->propH->value - text->lineNr * tf->height) / 2);
-            break;
+        //Note: texture upload binds the page textures directly
+        ctx->prevTex = INVALID_TEXTURE;
 
-        case AminoText::VALIGN_BASELINE:
-        default:
-            break;
+        if (text->pages.empty()) {
+            return;
+        }
     }
 
+    flushBatch();
+
+    ctx->save();
+
+    //flip the y axis
+    ctx->scale(1, -1);
+
+    //alignment
+    GLfloat offsetX, offsetY;
+
+    text->getTextOffset(offsetX, offsetY);
+    ctx->translate(offsetX, offsetY);
+
     //use texture
     if (DEBUG_RENDERER_ERRORS) {
         showGLErrors("updateTexture()");
     }
 
     glActiveTexture(GL_TEXTURE0);
-    ctx->bindTexture(texture);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     //font shader
-    ctx->useShader(fontShader);
+    AminoFontShader *shader = fontShader;
+
+    if (text->fontSize->font->sdf) {
+        //distance field glyphs
+        if (!sdfFontShader) {
+            sdfFontShader = new AminoSdfFontShader();
+
+            bool res = sdfFontShader->create();
+
+            assert(res);
+        }
+
+        shader = sdfFontShader;
+    }
+
+    ctx->useShader(shader);
 
     //color & opacity
-    fontShader->setTransformation(modelView, ctx->globaltx);
-    fontShader->setOpacity(ctx->opacity * text->propOpacity->value);
+    shader->setTransformation(modelView, ctx->globaltx);
+    shader->setOpacity(ctx->opacity * text->propOpacity->value);
 
     GLfloat color[3] = { text->propR->value, text->propG->value, text->propB->value };
 
-    fontShader->setColor(color);
+    shader->setColor(color);
+
+    if (shader == sdfFontShader) {
+        //anti-aliasing: one pixel on screen (scaled glyphs and transformation)
+        GLfloat *m = ctx->globaltx;
+        GLfloat glyphScale = text->fontSize->scale;
+        GLfloat pixelsPerTexel = sqrtf(fabsf(m[0] * m[5] - m[1] * m[4])) * glyphScale;
+
+        sdfFontShader->setSmoothing(0.25f / (SDF_SPREAD * std::max(pixelsPerTexel, 0.01f)));
+
+        //outline (in text coordinates)
+        GLfloat outline = std::min(text->propOutlineWidth->value / (2 * SDF_SPREAD * glyphScale), 0.45f);
+        GLfloat outlineColor[3] = { text->propOutlineR->value, text->propOutlineG->value, text->propOutlineB->value };
+
+        sdfFontShader->setOutline(std::max(outline, 0.0f), outlineColor);
+    }
 
     if (DEBUG_RENDERER_ERRORS) {
         showGLErrors("before text rendering");
     }
 
-    //render
-    vertex_buffer_render(text->buffer, GL_TRIANGLES);
+    //render (one draw call per atlas page)
+    vertex_buffer_render_setup(text->buffer, GL_TRIANGLES);
+
+    for (auto const &page : text->pages) {
+        ctx->bindTexture(page.textureId);
+        glDrawElements(GL_TRIANGLES, page.count, GL_UNSIGNED_SHORT, (void *)(page.start * sizeof(GLushort)));
+    }
+
+    vertex_buffer_render_finish(text->buffer);
 
     if (DEBUG_RENDERER_ERRORS) {
         showGLErrors("after text rendering");
@@ -1022,10 +1954,10 @@ void AminoRenderer::drawText(AminoText *text) {
  *
  * Note: has to be called on OpenGL thread (if createIfMissing is true).
  */
-amino_atlas_t AminoRenderer::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
+amino_atlas_t* AminoRenderer::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
     assert(fontShader);
 
-    amino_atlas_t res = fontShader->getAtlasTexture(atlas, createIfMissing, newTexture);
+    amino_atlas_t *res = fontShader->getAtlasTexture(atlas, createIfMissing, newTexture);
 
     if (newTexture) {
         gfx->notifyTextureCreated(1);
@@ -1136,4 +2068,160 @@ void AminoRenderer::checkTexturePerformance() {
     delete[] data;
 
     glDeleteTextures(1, &textureId);
-}
\ No newline at end of file
+}
+
+/**
+ * Check matrix and opacity stack performance (compared to heap allocated stack entries).
+ */
+void AminoRenderer::checkContextPerformance() {
+    const int cycles = 1000000;
+    double startTime, diff;
+
+    printf("Context stack performance: %i cycles\n", cycles);
+
+    //heap allocated entries (previous implementation)
+    std::stack<void *> heapStack;
+    GLfloat *heapMatrix = new GLfloat[16];
+
+    make_identity_matrix(heapMatrix);
+
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        //save
+        GLfloat *temp = new GLfloat[16];
+
+        copy_matrix(temp, heapMatrix);
+        heapStack.push(heapMatrix);
+        heapMatrix = temp;
+
+        //save opacity
+        GLfloat *opacity = new GLfloat[1];
+
+        opacity[0] = 1;
+        heapStack.push(opacity);
+
+        //restore opacity
+        opacity = (GLfloat *)heapStack.top();
+        heapStack.pop();
+        delete[] opacity;
+
+        //restore
+        delete[] heapMatrix;
+        heapMatrix = (GLfloat *)heapStack.top();
+        heapStack.pop();
+    }
+
+    diff = getTime() - startTime;
+    printf("-> heap: %i ms\n", (int)diff);
+
+    delete[] heapMatrix;
+
+    //preallocated stacks
+    GLContext *ctx = new GLContext();
+
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        ctx->save();
+        ctx->saveOpacity();
+        ctx->restoreOpacity();
+        ctx->restore();
+    }
+
+    diff = getTime() - startTime;
+    printf("-> preallocated: %i ms\n", (int)diff);
+
+    delete ctx;
+}
+
+/**
+ * Check per node transformation performance (separate matrices compared to fused matrix).
+ */
+void AminoRenderer::checkMatrixPerformance() {
+    const int cycles = 1000000;
+    double startTime, diff;
+    GLContext *ctx = new GLContext();
+
+    printf("Matrix performance: %i nodes\n", cycles);
+
+    //separate matrices (previous implementation)
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        GLfloat rotation = (GLfloat)(i % 360);
+        GLfloat m[16];
+        GLfloat temp[16];
+
+        ctx->save();
+
+        ctx->translate(50, 50);
+        ctx->translate(10, 20, 0);
+        ctx->scale(1, 1);
+
+        //all three rotations
+        make_x_rot_matrix(0, m);
+        mul_matrix(temp, ctx->globaltx, m);
+        copy_matrix(ctx->globaltx, temp);
+
+        make_y_rot_matrix(0, m);
+        mul_matrix(temp, ctx->globaltx, m);
+        copy_matrix(ctx->globaltx, temp);
+
+        make_z_rot_matrix(rotation, m);
+        mul_matrix(temp, ctx->globaltx, m);
+        copy_matrix(ctx->globaltx, temp);
+
+        ctx->translate(-50, -50);
+
+        ctx->restore();
+    }
+
+    diff = getTime() - startTime;
+    printf("-> separate: %i ms\n", (int)diff);
+
+    //fused matrix
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        GLfloat rotation = (GLfloat)(i % 360);
+
+        ctx->save();
+        ctx->transform(50, 50, 10, 20, 0, 1, 1, 0, 0, rotation);
+        ctx->restore();
+    }
+
+    diff = getTime() - startTime;
+    printf("-> fused: %i ms\n", (int)diff);
+
+    //translation only
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        ctx->save();
+        ctx->transform(0, 0, 10, (GLfloat)(i % 100), 0, 1, 1, 0, 0, 0);
+        ctx->restore();
+    }
+
+    diff = getTime() - startTime;
+    printf("-> fused (translation only): %i ms\n", (int)diff);
+
+    //inversion
+    GLfloat m[16];
+    GLfloat inv[16];
+
+    make_trs_matrix(50, 50, 10, 20, 0, 2, 2, 10, 20, 30, m);
+
+    startTime = getTime();
+
+    for (int i = 0; i < cycles; i++) {
+        m[12] = (GLfloat)(i % 100);
+
+        invert_matrix(m, inv);
+    }
+
+    diff = getTime() - startTime;
+    printf("-> inversion: %i ms\n", (int)diff);
+
+    delete ctx;
+}
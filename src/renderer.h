@@ -5,15 +5,21 @@
 
 #include "mathutils.h"
 
-#include <stack>
+#include <vector>
+
+//initial stack sizes (grow if exceeded)
+#define MATRIX_STACK_SIZE 32
+#define OPACITY_STACK_SIZE 32
+
+//damage tracking: max buffer age
+#define DAMAGE_HISTORY_SIZE 4
 
 /**
  * Rendering context.
  */
 class GLContext {
 public:
-    std::stack<void *> matrixStack;
-    GLfloat *globaltx = new GLfloat[16];
+    GLfloat *globaltx = NULL;
     GLfloat opacity = 1;
 
     int depth = 0;
@@ -25,7 +31,12 @@ public:
      * Constructor.
      */
     GLContext() {
+        //stacks (preallocated)
+        matrixStack.resize(16 * MATRIX_STACK_SIZE);
+        opacityStack.reserve(OPACITY_STACK_SIZE);
+
         //matrix
+        globaltx = matrixStack.data();
         make_identity_matrix(globaltx);
     }
 
@@ -33,15 +44,16 @@ public:
      * Destructor.
      */
     virtual ~GLContext() {
-        assert(matrixStack.empty());
-        delete[] globaltx;
+        assert(matrixDepth == 0);
+        assert(opacityStack.empty());
     }
 
     /**
      * Reset context (prepare for next cycle).
      */
     void reset() {
-        assert(matrixStack.empty());
+        assert(matrixDepth == 0);
+        assert(opacityStack.empty());
         assert(depth == 0);
 
         //reset
@@ -96,19 +108,25 @@ public:
         GLfloat temp[16];
 
         //x-rotation
-        make_x_rot_matrix(x, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (x != 0) {
+            make_x_rot_matrix(x, rot);
+            mul_matrix(temp, globaltx, rot);
+            copy_matrix(globaltx, temp);
+        }
 
         //y-rotation
-        make_y_rot_matrix(y, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (y != 0) {
+            make_y_rot_matrix(y, rot);
+            mul_matrix(temp, globaltx, rot);
+            copy_matrix(globaltx, temp);
+        }
 
         //z-rotation
-        make_z_rot_matrix(z, rot);
-        mul_matrix(temp, globaltx, rot);
-        copy_matrix(globaltx, temp);
+        if (z != 0) {
+            make_z_rot_matrix(z, rot);
+            mul_matrix(temp, globaltx, rot);
+            copy_matrix(globaltx, temp);
+        }
     }
 
     /**
@@ -123,6 +141,19 @@ public:
         copy_matrix(globaltx, temp);
     }
 
+    /**
+     * Apply node transformation (single matrix multiplication).
+     *
+     * Same as: translate(origin), translate(x, y, z), scale(sx, sy), rotate(rx, ry, rz), translate(-origin)
+     */
+    void transform(GLfloat originX, GLfloat originY, GLfloat x, GLfloat y, GLfloat z, GLfloat scaleX, GLfloat scaleY, GLfloat rotateX, GLfloat rotateY, GLfloat rotateZ) {
+        GLfloat local[16];
+
+        if (make_trs_matrix(originX, originY, x, y, z, scaleX, scaleY, rotateX, rotateY, rotateZ, local)) {
+            mul_matrix(globaltx, globaltx, local);
+        }
+    }
+
     /**
      * Set opacity value.
      */
@@ -136,46 +167,66 @@ public:
      * Save opacity.
      */
     void saveOpacity() {
-        GLfloat *temp = new GLfloat[1];
-
-        temp[0] = opacity;
-        matrixStack.push(temp);
+        //Note: only allocates if the reserved size is exceeded
+        opacityStack.push_back(opacity);
     }
 
     /**
      * Restore the opacity.
      */
     void restoreOpacity() {
-        GLfloat *temp = (GLfloat *)matrixStack.top();
-
-        matrixStack.pop();
+        assert(!opacityStack.empty());
 
-        opacity = temp[0];
-        delete[] temp;
+        opacity = opacityStack.back();
+        opacityStack.pop_back();
     }
 
     /**
      * Save matrix.
      */
     void save() {
-        //matrix
-        GLfloat *temp = new GLfloat[16];
+        matrixDepth++;
 
-        copy_matrix(temp, globaltx);
-        matrixStack.push(globaltx);
+        std::size_t offset = matrixDepth * 16;
+
+        if (offset + 16 > matrixStack.size()) {
+            //grow (keeps the size for the following frames)
+            matrixStack.resize(matrixStack.size() * 2);
+        }
+
+        //copy current matrix to next slot
+        GLfloat *temp = matrixStack.data() + offset;
+
+        copy_matrix(temp, temp - 16);
         globaltx = temp;
     }
 
+    /**
+     * Save matrix and use a new matrix.
+     */
+    void save(const GLfloat *matrix) {
+        matrixDepth++;
+
+        std::size_t offset = matrixDepth * 16;
+
+        if (offset + 16 > matrixStack.size()) {
+            //grow
+            matrixStack.resize(matrixStack.size() * 2);
+        }
+
+        //copy matrix to next slot
+        globaltx = matrixStack.data() + offset;
+        copy_matrix(globaltx, matrix);
+    }
+
     /**
      * Restore matrix.
      */
     void restore() {
-        //matrix
-        delete[] globaltx;
-        globaltx = (GLfloat *)matrixStack.top();
-        matrixStack.pop();
+        assert(matrixDepth > 0);
 
-        assert(globaltx);
+        matrixDepth--;
+        globaltx = matrixStack.data() + matrixDepth * 16;
     }
 
     /**
@@ -260,8 +311,40 @@ public:
             glDepthMask(GL_FALSE);
         }
     }
+
+private:
+    //matrix stack (contiguous 4x4 matrices, globaltx points to the top)
+    std::vector<GLfloat> matrixStack;
+    std::size_t matrixDepth = 0;
+
+    //opacity stack
+    std::vector<GLfloat> opacityStack;
 };
 
+//end of group command
+#define COMMAND_GROUP_END 0
+
+/**
+ * Recorded draw command.
+ */
+typedef struct {
+    AminoNode *node;
+    AminoNode *parent;
+    int type;
+    std::size_t size; //commands including children (groups)
+    uint32_t version; //recorded children (groups)
+} draw_command_t;
+
+/**
+ * Clipping state (saved by groups with clipRect).
+ */
+typedef struct {
+    bool scissorTest;
+    GLint scissor[4];
+    GLint stencilRef;
+    bool usesStencil;
+} clip_state_t;
+
 /**
  * OpenGL ES 2.0 renderer.
  */
@@ -277,17 +360,27 @@ public:
     virtual void initScene(GLfloat r, GLfloat g, GLfloat b, GLfloat opacity);
     virtual void renderScene(AminoNode *node);
 
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void setCulling(bool enabled);
+    bool updateDamage(AminoNode *node, int bufferAge, GLfloat threshold, GLint *rect);
+    void invalidateDamage();
+    void invalidateCommands();
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+    amino_atlas_t* getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
 
     static int showGLErrors();
     static int showGLErrors(std::string msg);
 
     static void checkTexturePerformance();
+    static void checkContextPerformance();
+    static void checkMatrixPerformance();
 
 protected:
     virtual void render(AminoNode *node);
 
-    virtual void drawGroup(AminoGroup *group);
+    virtual void beginGroup(AminoGroup *group);
+    virtual void endGroup(AminoGroup *group);
     virtual void drawRect(AminoRect *rect);
     virtual void drawPoly(AminoPolygon *poly);
     virtual void drawModel(AminoModel *model);
@@ -298,14 +391,38 @@ private:
 
     //basic shaders
     AminoFontShader *fontShader = NULL;
+    AminoSdfFontShader *sdfFontShader = NULL;
     ColorShader *colorShader = NULL;
     TextureShader *textureShader = NULL;
-    TextureClampToBorderShader *textureClampToBorderShader = NULL;
+
+    //unit quad (static VBO)
+    QuadShader *quadShader = NULL;
+    QuadTextureShader *quadTextureShader = NULL;
+    GLuint quadBuffer = INVALID_BUFFER;
+    GLuint quadIndexBuffer = INVALID_BUFFER;
+    GLuint quadVao = INVALID_BUFFER;
+    GLuint quadTextureVao = INVALID_BUFFER;
+    bool vaoSupported = false;
+
+#if defined RPI && defined GL_OES_vertex_array_object
+    PFNGLGENVERTEXARRAYSOESPROC genVertexArrays = NULL;
+    PFNGLBINDVERTEXARRAYOESPROC bindVertexArray = NULL;
+    PFNGLDELETEVERTEXARRAYSOESPROC deleteVertexArrays = NULL;
+#endif
 
     //model shaders
     ColorLightingShader *colorLightingShader = NULL;
     TextureLightingShader *textureLightingShader = NULL;
 
+    //batching
+    BatchShader *batchShader = NULL;
+    BatchTextureShader *batchTextureShader = NULL;
+    GLuint batchBuffer = INVALID_BUFFER;
+    std::vector<batch_vertex_t> batchVertices;
+    BatchShader *batchActiveShader = NULL;
+    GLuint batchTexture = INVALID_TEXTURE;
+    bool batchBlend = false;
+
     //perspective
     bool orthographic = true;
     float near = 150;
@@ -321,8 +438,58 @@ private:
     GLfloat modelView[16];
     GLContext *ctx = NULL;
 
+    //damage tracking (window coordinates)
+    GLfloat viewportSize[2] = { 0, 0 };
+    uint32_t viewVersion = 1;
+    bool damageAll = true;
+    bool damagePartial = false;
+    GLint damageRect[4] = { 0, 0, 0, 0 };
+    GLfloat frameDamage[4];
+    GLfloat damageHistory[DAMAGE_HISTORY_SIZE][4];
+    int damageHistoryCount = 0;
+    std::vector<GLfloat> boundsStack;
+    bool boundsUpdated = false;
+
+    //clipping
+    bool scissorTest = false;
+    GLint scissor[4] = { 0, 0, 0, 0 };
+    GLint stencilRef = 0; //0: no stencil clipping
+    GLint stencilCounter = 0;
+    std::vector<clip_state_t> clipStack;
+
+    //culling (visible region per group level)
+    bool culling = true;
+    std::vector<GLfloat> cullStack;
+    uint32_t culledNodes = 0;
+    uint32_t culledGroups = 0;
+
+    //recorded commands
+    std::vector<draw_command_t> commands;
+    std::vector<draw_command_t> recordBuffer;
+    std::vector<std::size_t> groupStack;
+    bool recordAll = true;
+
+    void recordNode(AminoNode *node, AminoNode *parent, std::vector<draw_command_t> &list);
+    void recordGroup(std::size_t index);
+    void renderCommands();
+
+    bool getScissorRect(GLfloat w, GLfloat h, GLint *rect);
+    void drawStencilQuad(GLfloat w, GLfloat h);
+
+    void updateBounds();
+    void updateNodeDamage(AminoNode *node, GLfloat *bounds, bool changed);
+    void addDamage(GLfloat *bounds);
+    bool projectBounds(GLfloat *matrix, GLfloat *local, GLfloat *bounds);
+
     void applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat color[4], GLenum mode = GL_TRIANGLES);
-    void applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat uv[][2], GLuint texId, GLfloat opacity, bool needsClampToBorder, bool repeatX, bool repeatY);
+
+    void initQuadBuffer();
+    bool bindQuadBuffer(GLuint &vao);
+    void unbindQuadBuffer();
+    void drawTextureQuad(GLfloat w, GLfloat h, GLfloat uv[4], GLuint texId, GLfloat opacity, bool repeatX, bool repeatY);
+
+    void batchQuad(BatchShader *shader, GLuint texId, bool blend, GLfloat w, GLfloat h, GLfloat color[4], GLfloat uv[4]);
+    void flushBatch();
 };
 
 #endif
@@ -1711,10 +1711,84 @@ void AminoGfxRPi::initRenderer() {
         assert(res == EGL_TRUE);
     }
 
+    //partial redraws
+    if (damageTracking) {
+        initDamageExtensions();
+    }
+
     //input
     initInput();
 }
 
+/**
+ * Check the EGL extensions needed for partial redraws.
+ */
+void AminoGfxRPi::initDamageExtensions() {
+    const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+
+    if (!extensions) {
+        return;
+    }
+
+#ifdef EGL_EXT_buffer_age
+    bufferAgeSupported = strstr(extensions, "EGL_EXT_buffer_age") != NULL;
+#endif
+
+#ifdef EGL_KHR_partial_update
+    if (strstr(extensions, "EGL_KHR_partial_update")) {
+        bufferAgeSupported = true;
+        eglSetDamageRegion = (PFNEGLSETDAMAGEREGIONKHRPROC)eglGetProcAddress("eglSetDamageRegionKHR");
+    }
+#endif
+
+#ifdef EGL_KHR_swap_buffers_with_damage
+    if (strstr(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+        eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    } else if (strstr(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+        //same signature
+        eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+    }
+#endif
+
+    if (DEBUG_GLES) {
+        printf("-> buffer age: %s\n", bufferAgeSupported ? "yes":"no");
+    }
+}
+
+/**
+ * Get the age of the back buffer.
+ */
+int AminoGfxRPi::getBufferAge() {
+    if (!bufferAgeSupported) {
+        return 0;
+    }
+
+    EGLint age = 0;
+
+    //Note: EGL_BUFFER_AGE_KHR has the same value
+#ifdef EGL_BUFFER_AGE_EXT
+    if (eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, &age) != EGL_TRUE) {
+        return 0;
+    }
+#endif
+
+    return age;
+}
+
+/**
+ * Limit the next frame to the damaged region (EGL_KHR_partial_update).
+ */
+void AminoGfxRPi::setDamageRegion() {
+#ifdef EGL_KHR_partial_update
+    //Note: skipped if nothing changed (no 0x0 rects; nothing is drawn)
+    if (eglSetDamageRegion && damagePartial && damageRect[2] > 0 && damageRect[3] > 0) {
+        EGLBoolean res = eglSetDamageRegion(display, surface, damageRect, 1);
+
+        assert(res == EGL_TRUE);
+    }
+#endif
+}
+
 #ifdef EGL_DISPMANX
 /**
  * Get EGL surface from Dispmanx (RPi 3 and lower).
@@ -2154,7 +2228,20 @@ void AminoGfxRPi::renderingDone() {
     }
 
     //swap buffer
-    EGLBoolean res = eglSwapBuffers(display, surface);
+    EGLBoolean res;
+
+#ifdef EGL_KHR_swap_buffers_with_damage
+    if (eglSwapBuffersWithDamage && damagePartial) {
+        //only the damaged region changed (Note: n_rects = 0 if nothing changed, same as a full swap)
+        bool empty = damageRect[2] == 0 || damageRect[3] == 0;
+
+        res = eglSwapBuffersWithDamage(display, surface, empty ? NULL:damageRect, empty ? 0:1);
+    } else {
+        res = eglSwapBuffers(display, surface);
+    }
+#else
+    res = eglSwapBuffers(display, surface);
+#endif
 
     assert(res == EGL_TRUE);
 
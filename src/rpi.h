@@ -72,6 +72,17 @@ private:
     bool pageFlipPending = false;
 #endif
 
+    //damage (EGL extensions)
+    bool bufferAgeSupported = false;
+
+#ifdef EGL_KHR_partial_update
+    PFNEGLSETDAMAGEREGIONKHRPROC eglSetDamageRegion = NULL;
+#endif
+
+#ifdef EGL_KHR_swap_buffers_with_damage
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC eglSwapBuffersWithDamage = NULL;
+#endif
+
     //resolution
     std::string prefRes = "";
 
@@ -149,6 +160,10 @@ private:
     void initInput();
     void initTouch(int fd);
 
+    void initDamageExtensions();
+    int getBufferAge() override;
+    void setDamageRegion() override;
+
     void start() override;
     bool bindContext() override;
     void renderingDone() override;
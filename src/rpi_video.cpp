@@ -311,6 +311,7 @@ void AminoOmxVideoPlayer::handleFillBufferDone(void *data, COMPONENT_T *comp) {
 
     uv_mutex_unlock(&player->bufferLock);
 
+    player->handleFrameAvailable();
     player->omxFillNextEglBuffer();
 }
 
@@ -627,6 +627,276 @@ void TextureClampToBorderShader::setRepeat(bool repeatX, bool repeatY) {
     glUniform2i(uRepeat, repeatX, repeatY);
 }
 
+//
+// QuadShader
+//
+
+/**
+ * Create unit quad color shader.
+ */
+QuadShader::QuadShader() : ColorShader() {
+    //Note: vertices are in the range 0..1
+    vertexShader = R"(
+        uniform mat4 mvp;
+        uniform mat4 trans;
+        uniform vec2 size;
+
+        attribute vec2 pos;
+
+        void main() {
+            gl_Position = mvp * trans * vec4(pos * size, 0., 1.);
+        }
+    )";
+}
+
+/**
+ * Initialize the unit quad color shader.
+ */
+void QuadShader::initShader() {
+    ColorShader::initShader();
+
+    //uniforms
+    uSize = getUniformLocation("size");
+}
+
+/**
+ * Set quad size.
+ */
+void QuadShader::setSize(GLfloat w, GLfloat h) {
+    glUniform2f(uSize, w, h);
+}
+
+/**
+ * Set vertex data (using bound VBO).
+ */
+void QuadShader::setVertexBuffer() {
+    glVertexAttribPointer(aPos, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+}
+
+//
+// QuadTextureShader
+//
+
+/**
+ * Create unit quad texture shader.
+ */
+QuadTextureShader::QuadTextureShader() : TextureClampToBorderShader() {
+    //Note: texture coordinates are in the range 0..1 (mapped to the texture rect)
+    vertexShader = R"(
+        uniform mat4 mvp;
+        uniform mat4 trans;
+        uniform vec2 size;
+        uniform vec4 texRect;
+
+        attribute vec2 pos;
+        attribute vec2 texCoord;
+
+        varying vec2 uv;
+
+        void main() {
+            gl_Position = mvp * trans * vec4(pos * size, 0., 1.);
+            uv = mix(texRect.xy, texRect.zw, texCoord);
+        }
+    )";
+}
+
+/**
+ * Initialize the unit quad texture shader.
+ */
+void QuadTextureShader::initShader() {
+    TextureClampToBorderShader::initShader();
+
+    //uniforms
+    uSize = getUniformLocation("size");
+    uTexRect = getUniformLocation("texRect");
+}
+
+/**
+ * Set quad size.
+ */
+void QuadTextureShader::setSize(GLfloat w, GLfloat h) {
+    glUniform2f(uSize, w, h);
+}
+
+/**
+ * Set texture rect (left, top, right, bottom).
+ */
+void QuadTextureShader::setTextureRect(GLfloat uv[4]) {
+    glUniform4f(uTexRect, uv[0], uv[1], uv[2], uv[3]);
+}
+
+/**
+ * Set vertex data (using bound VBO).
+ *
+ * Note: the unit quad vertices are used as texture coordinates too.
+ */
+void QuadTextureShader::setVertexBuffer() {
+    glVertexAttribPointer(aPos, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+    glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+}
+
+//
+// BatchShader
+//
+
+/**
+ * Create batch shader.
+ */
+BatchShader::BatchShader() : AnyAminoShader() {
+    //Note: vertices are already transformed by the renderer
+    vertexShader = R"(
+        uniform mat4 mvp;
+
+        attribute vec4 pos;
+        attribute vec4 color;
+
+        varying vec4 vColor;
+
+        void main() {
+            gl_Position = mvp * pos;
+            vColor = color;
+        }
+    )";
+
+    fragmentShader = R"(
+#ifdef EGL_GBM
+        precision highp float;
+#endif
+        varying vec4 vColor;
+
+        void main() {
+            gl_FragColor = vColor;
+        }
+    )";
+}
+
+/**
+ * Initialize the batch shader.
+ */
+void BatchShader::initShader() {
+    useShader(false);
+
+    //attributes
+    aPos = getAttributeLocation("pos");
+    aColor = getAttributeLocation("color");
+
+    //uniforms
+    uMVP = getUniformLocation("mvp");
+    uTrans = -1;
+}
+
+/**
+ * Set model view matrix.
+ */
+void BatchShader::setModelView(GLfloat modelView[16]) {
+    glUniformMatrix4fv(uMVP, 1, GL_FALSE, modelView);
+}
+
+/**
+ * Set vertex data (using bound VBO).
+ */
+void BatchShader::setVertexBuffer() {
+    glVertexAttribPointer(aPos, 4, GL_FLOAT, GL_FALSE, sizeof(batch_vertex_t), (GLvoid *)offsetof(batch_vertex_t, pos));
+    glVertexAttribPointer(aColor, 4, GL_FLOAT, GL_FALSE, sizeof(batch_vertex_t), (GLvoid *)offsetof(batch_vertex_t, color));
+}
+
+/**
+ * Draw triangles.
+ */
+void BatchShader::drawTriangles(GLsizei vertices, GLenum mode) {
+    glEnableVertexAttribArray(aColor);
+
+    AnyAminoShader::drawTriangles(vertices, mode);
+
+    glDisableVertexAttribArray(aColor);
+}
+
+//
+// BatchTextureShader
+//
+
+/**
+ * Create batch texture shader.
+ */
+BatchTextureShader::BatchTextureShader() : BatchShader() {
+    vertexShader = R"(
+        uniform mat4 mvp;
+
+        attribute vec4 pos;
+        attribute vec4 color;
+        attribute vec2 texCoord;
+
+        varying vec4 vColor;
+        varying vec2 uv;
+
+        void main() {
+            gl_Position = mvp * pos;
+            vColor = color;
+            uv = texCoord;
+        }
+    )";
+
+    //Note: opacity is stored in the alpha value of the vertex color
+    fragmentShader = R"(
+#ifdef EGL_GBM
+        precision highp float;
+#endif
+        varying vec4 vColor;
+        varying vec2 uv;
+
+        uniform sampler2D tex;
+
+        void main() {
+            vec4 pixel = texture2D(tex, uv);
+
+            //discard transparent pixels
+            if (pixel.a == 0.) {
+                discard;
+            }
+
+            gl_FragColor = vec4(pixel.rgb, pixel.a * vColor.a);
+        }
+    )";
+}
+
+/**
+ * Initialize the batch texture shader.
+ */
+void BatchTextureShader::initShader() {
+    BatchShader::initShader();
+
+    //attributes
+    aTexCoord = getAttributeLocation("texCoord");
+
+    //uniforms
+    uTex = getUniformLocation("tex");
+
+    //default values
+    glUniform1i(uTex, 0); //GL_TEXTURE0
+}
+
+/**
+ * Set vertex data (using bound VBO).
+ */
+void BatchTextureShader::setVertexBuffer() {
+    BatchShader::setVertexBuffer();
+
+    glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(batch_vertex_t), (GLvoid *)offsetof(batch_vertex_t, uv));
+}
+
+/**
+ * Draw textured triangles.
+ */
+void BatchTextureShader::drawTriangles(GLsizei vertices, GLenum mode) {
+    glEnableVertexAttribArray(aTexCoord);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    BatchShader::drawTriangles(vertices, mode);
+
+    glDisableVertexAttribArray(aTexCoord);
+}
+
 //
 // TextureLightingShader
 //
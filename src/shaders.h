@@ -4,6 +4,7 @@
 #include "gfx.h"
 
 #include <string>
+#include <cstddef>
 
 /**
  * Shader base class.
@@ -143,6 +144,96 @@ protected:
     void initShader() override;
 };
 
+/**
+ * Unit quad color shader (quad scaled by size uniform).
+ */
+class QuadShader : public ColorShader {
+public:
+    QuadShader();
+
+    //params
+    void setSize(GLfloat w, GLfloat h);
+
+    //per vertex data
+    void setVertexBuffer();
+
+protected:
+    GLint uSize;
+
+    void initShader() override;
+};
+
+/**
+ * Unit quad texture shader (quad scaled by size uniform, texture coordinates by texture rect).
+ */
+class QuadTextureShader : public TextureClampToBorderShader {
+public:
+    QuadTextureShader();
+
+    //params
+    void setSize(GLfloat w, GLfloat h);
+    void setTextureRect(GLfloat uv[4]);
+
+    //per vertex data
+    void setVertexBuffer();
+
+protected:
+    GLint uSize, uTexRect;
+
+    void initShader() override;
+};
+
+/**
+ * Batch vertex (pre-transformed position, color and texture coordinates).
+ */
+typedef struct {
+    GLfloat pos[4];
+    GLfloat color[4];
+    GLfloat uv[2];
+} batch_vertex_t;
+
+/**
+ * Batch shader (pre-transformed vertices with per vertex color).
+ */
+class BatchShader : public AnyAminoShader {
+public:
+    BatchShader();
+
+    //params
+    void setModelView(GLfloat modelView[16]);
+
+    //per vertex data
+    virtual void setVertexBuffer();
+
+    //draw
+    void drawTriangles(GLsizei vertices, GLenum mode) override;
+
+protected:
+    GLint aColor;
+
+    void initShader() override;
+};
+
+/**
+ * Batch texture shader (pre-transformed vertices with per vertex opacity).
+ */
+class BatchTextureShader : public BatchShader {
+public:
+    BatchTextureShader();
+
+    //per vertex data
+    void setVertexBuffer() override;
+
+    //draw
+    void drawTriangles(GLsizei vertices, GLenum mode) override;
+
+protected:
+    GLint aTexCoord;
+    GLint uTex;
+
+    void initShader() override;
+};
+
 /**
  * Texture Lighting Shader.
  */
@@ -431,6 +431,19 @@ void AminoVideoPlayer::handleRewind() {
     fireEvent("rewind");
 }
 
+/**
+ * New video frame is available.
+ *
+ * Note: called on decoder thread.
+ */
+void AminoVideoPlayer::handleFrameAvailable() {
+    AminoJSEventObject *eventHandler = texture->getEventHandler();
+
+    if (eventHandler) {
+        eventHandler->notifyUpdate();
+    }
+}
+
 /**
  * Fire video player event.
  */
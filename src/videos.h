@@ -130,6 +130,7 @@ protected:
     void handleInitDone(bool ready);
 
     void handleRewind();
+    void handleFrameAvailable();
 
     void fireEvent(std::string event);
 };